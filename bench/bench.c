@@ -0,0 +1,475 @@
+// Host microbenchmarks for the drawing, font, image and string code.
+// Built natively by `make bench` against the stand-in headers in bench/efi.
+// The firmware is replaced by a RAM framebuffer, a Blt that copies into it and
+// malloc-backed pool/page allocators, so the numbers measure our code rather
+// than any particular GOP driver.
+//
+// Usage: hatteros_bench [results.csv]
+// Every benchmark prints one line and appends one CSV row to the results file.
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// shell.c is compiled into this file so its static helpers can be timed.
+#include "shell.c"
+
+#define BENCH_WIDTH 1024
+#define BENCH_HEIGHT 768
+#define BENCH_MIN_NS 200000000ULL
+#define BENCH_TEXT_LINE "drwxr-xr-x  4096  2026-10-15 12:00  HATTEROS/system/config/shell.cfg  0123456789"
+
+#ifndef BENCH_GIT_REV
+#define BENCH_GIT_REV "unknown"
+#endif
+
+typedef void (*BenchFn)(UINT64 iterations);
+
+typedef struct {
+    const char *name;
+    BenchFn fn;
+    UINT64 units_per_op;
+    const char *unit;
+} BenchCase;
+
+// In-memory file for the image decoders: Read, SetPosition and GetPosition.
+typedef struct {
+    EFI_FILE_PROTOCOL proto;
+    const UINT8 *data;
+    UINT64 size;
+    UINT64 pos;
+} BenchFile;
+
+static UINT32 *bench_vram;
+static EFI_GRAPHICS_OUTPUT_MODE_INFORMATION bench_mode_info;
+static EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE bench_gop_mode;
+static EFI_GRAPHICS_OUTPUT_PROTOCOL bench_gop;
+static EFI_BOOT_SERVICES bench_bs;
+static EFI_RUNTIME_SERVICES bench_rt;
+static EFI_SYSTEM_TABLE bench_st;
+
+static GfxContext bench_gfx;
+static Shell bench_shell;
+static UINT8 *bench_bmp24;
+static UINT8 *bench_bmp32;
+static UINTN bench_bmp24_size;
+static UINTN bench_bmp32_size;
+static volatile UINT64 bench_sink;
+
+static UINT64 bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (UINT64)ts.tv_sec * 1000000000ULL + (UINT64)ts.tv_nsec;
+}
+
+// ---- Fake firmware ------------------------------------------------------
+
+static EFI_STATUS bench_allocate_pool(EFI_MEMORY_TYPE type, UINTN size, VOID **out) {
+    (void)type;
+    *out = malloc(size);
+    return (*out != NULL) ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES;
+}
+
+static EFI_STATUS bench_free_pool(VOID *ptr) {
+    free(ptr);
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_allocate_pages(EFI_ALLOCATE_TYPE type, EFI_MEMORY_TYPE mem, UINTN pages, EFI_PHYSICAL_ADDRESS *addr) {
+    (void)type;
+    (void)mem;
+    void *ptr = aligned_alloc(EFI_PAGE_SIZE, pages * EFI_PAGE_SIZE);
+    *addr = (EFI_PHYSICAL_ADDRESS)(UINTN)ptr;
+    return (ptr != NULL) ? EFI_SUCCESS : EFI_OUT_OF_RESOURCES;
+}
+
+static EFI_STATUS bench_free_pages(EFI_PHYSICAL_ADDRESS addr, UINTN pages) {
+    (void)pages;
+    free((void *)(UINTN)addr);
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_locate_handle_buffer(EFI_LOCATE_SEARCH_TYPE type, EFI_GUID *guid, VOID *key, UINTN *count, EFI_HANDLE **out) {
+    (void)type;
+    (void)guid;
+    (void)key;
+    *out = malloc(sizeof(EFI_HANDLE));
+    if (*out == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    (*out)[0] = &bench_gop;
+    *count = 1;
+    return EFI_SUCCESS;
+}
+
+// Only the GOP is available; everything else (loaded image, file system)
+// reports unsupported, so the shell skips its config file.
+static EFI_STATUS bench_handle_protocol(EFI_HANDLE handle, EFI_GUID *guid, VOID **out) {
+    (void)guid;
+    if (handle == &bench_gop) {
+        *out = &bench_gop;
+        return EFI_SUCCESS;
+    }
+    *out = NULL;
+    return EFI_UNSUPPORTED;
+}
+
+static EFI_STATUS bench_stall(UINTN microseconds) {
+    struct timespec ts;
+    ts.tv_sec = (time_t)(microseconds / 1000000);
+    ts.tv_nsec = (long)(microseconds % 1000000) * 1000;
+    nanosleep(&ts, NULL);
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_query_mode(EFI_GRAPHICS_OUTPUT_PROTOCOL *self, UINT32 mode, UINTN *size, EFI_GRAPHICS_OUTPUT_MODE_INFORMATION **info) {
+    (void)self;
+    if (mode != 0) {
+        return EFI_UNSUPPORTED;
+    }
+    *info = malloc(sizeof(**info));
+    if (*info == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    **info = bench_mode_info;
+    *size = sizeof(**info);
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_set_mode(EFI_GRAPHICS_OUTPUT_PROTOCOL *self, UINT32 mode) {
+    (void)self;
+    return (mode == 0) ? EFI_SUCCESS : EFI_UNSUPPORTED;
+}
+
+// Blt as a plain copy into the RAM framebuffer.
+static EFI_STATUS bench_blt(EFI_GRAPHICS_OUTPUT_PROTOCOL *self, EFI_GRAPHICS_OUTPUT_BLT_PIXEL *buffer,
+                            EFI_GRAPHICS_OUTPUT_BLT_OPERATION op, UINTN src_x, UINTN src_y, UINTN dst_x, UINTN dst_y,
+                            UINTN w, UINTN h, UINTN delta) {
+    (void)self;
+    UINT32 *src_pixels = (UINT32 *)buffer;
+    UINTN src_stride = (delta != 0) ? delta / sizeof(UINT32) : w;
+
+    switch (op) {
+    case EfiBltVideoFill:
+        for (UINTN y = 0; y < h; y++) {
+            UINT32 *dst = bench_vram + (dst_y + y) * BENCH_WIDTH + dst_x;
+            for (UINTN x = 0; x < w; x++) {
+                dst[x] = src_pixels[0];
+            }
+        }
+        return EFI_SUCCESS;
+    case EfiBltBufferToVideo:
+        for (UINTN y = 0; y < h; y++) {
+            memcpy(bench_vram + (dst_y + y) * BENCH_WIDTH + dst_x,
+                   src_pixels + (src_y + y) * src_stride + src_x,
+                   w * sizeof(UINT32));
+        }
+        return EFI_SUCCESS;
+    case EfiBltVideoToVideo:
+        for (UINTN i = 0; i < h; i++) {
+            UINTN y = (dst_y > src_y) ? (h - 1 - i) : i;
+            memmove(bench_vram + (dst_y + y) * BENCH_WIDTH + dst_x,
+                    bench_vram + (src_y + y) * BENCH_WIDTH + src_x,
+                    w * sizeof(UINT32));
+        }
+        return EFI_SUCCESS;
+    default:
+        return EFI_UNSUPPORTED;
+    }
+}
+
+static EFI_STATUS bench_file_read(EFI_FILE_PROTOCOL *self, UINTN *size, VOID *buf) {
+    BenchFile *file = (BenchFile *)self;
+    UINT64 left = (file->pos < file->size) ? file->size - file->pos : 0;
+    if (*size > left) {
+        *size = (UINTN)left;
+    }
+    memcpy(buf, file->data + file->pos, *size);
+    file->pos += *size;
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_file_set_position(EFI_FILE_PROTOCOL *self, UINT64 pos) {
+    BenchFile *file = (BenchFile *)self;
+    file->pos = (pos == 0xFFFFFFFFFFFFFFFFULL) ? file->size : pos;
+    return EFI_SUCCESS;
+}
+
+static EFI_STATUS bench_file_get_position(EFI_FILE_PROTOCOL *self, UINT64 *pos) {
+    *pos = ((BenchFile *)self)->pos;
+    return EFI_SUCCESS;
+}
+
+static void bench_file_init(BenchFile *file, const UINT8 *data, UINT64 size) {
+    memset(file, 0, sizeof(*file));
+    file->proto.Read = bench_file_read;
+    file->proto.SetPosition = bench_file_set_position;
+    file->proto.GetPosition = bench_file_get_position;
+    file->data = data;
+    file->size = size;
+}
+
+static void bench_put_le16(UINT8 *p, UINT16 v) {
+    p[0] = (UINT8)v;
+    p[1] = (UINT8)(v >> 8);
+}
+
+static void bench_put_le32(UINT8 *p, UINT32 v) {
+    bench_put_le16(p, (UINT16)v);
+    bench_put_le16(p + 2, (UINT16)(v >> 16));
+}
+
+// Bottom-up uncompressed BMP filled with a gradient.
+static UINT8 *bench_make_bmp(UINTN w, UINTN h, UINTN bpp, UINTN *out_size) {
+    UINTN row_bytes = ((w * bpp / 8) + 3) & ~(UINTN)3;
+    UINTN size = 54 + row_bytes * h;
+    UINT8 *bmp = calloc(1, size);
+    if (bmp == NULL) {
+        return NULL;
+    }
+    bmp[0] = 'B';
+    bmp[1] = 'M';
+    bench_put_le32(bmp + 2, (UINT32)size);
+    bench_put_le32(bmp + 10, 54);
+    bench_put_le32(bmp + 14, 40);
+    bench_put_le32(bmp + 18, (UINT32)w);
+    bench_put_le32(bmp + 22, (UINT32)h);
+    bench_put_le16(bmp + 26, 1);
+    bench_put_le16(bmp + 28, (UINT16)bpp);
+    for (UINTN y = 0; y < h; y++) {
+        UINT8 *row = bmp + 54 + y * row_bytes;
+        for (UINTN x = 0; x < w; x++) {
+            UINT8 *px = row + x * (bpp / 8);
+            px[0] = (UINT8)x;
+            px[1] = (UINT8)y;
+            px[2] = (UINT8)(x ^ y);
+        }
+    }
+    *out_size = size;
+    return bmp;
+}
+
+static int bench_setup(void) {
+    bench_vram = calloc(BENCH_WIDTH * BENCH_HEIGHT, sizeof(UINT32));
+    if (bench_vram == NULL) {
+        return 0;
+    }
+
+    bench_mode_info.HorizontalResolution = BENCH_WIDTH;
+    bench_mode_info.VerticalResolution = BENCH_HEIGHT;
+    bench_mode_info.PixelFormat = PixelBlueGreenRedReserved8BitPerColor;
+    bench_mode_info.PixelsPerScanLine = BENCH_WIDTH;
+    bench_gop_mode.MaxMode = 1;
+    bench_gop_mode.Mode = 0;
+    bench_gop_mode.Info = &bench_mode_info;
+    bench_gop_mode.SizeOfInfo = sizeof(bench_mode_info);
+    bench_gop_mode.FrameBufferBase = (EFI_PHYSICAL_ADDRESS)(UINTN)bench_vram;
+    bench_gop_mode.FrameBufferSize = BENCH_WIDTH * BENCH_HEIGHT * sizeof(UINT32);
+    bench_gop.QueryMode = bench_query_mode;
+    bench_gop.SetMode = bench_set_mode;
+    bench_gop.Blt = bench_blt;
+    bench_gop.Mode = &bench_gop_mode;
+
+    bench_bs.AllocatePool = bench_allocate_pool;
+    bench_bs.FreePool = bench_free_pool;
+    bench_bs.AllocatePages = bench_allocate_pages;
+    bench_bs.FreePages = bench_free_pages;
+    bench_bs.LocateHandleBuffer = bench_locate_handle_buffer;
+    bench_bs.HandleProtocol = bench_handle_protocol;
+    bench_bs.Stall = bench_stall;
+    bench_st.BootServices = &bench_bs;
+    bench_st.RuntimeServices = &bench_rt;
+
+    if (EFI_ERROR(gfx_init(&bench_st, &bench_gfx, BENCH_WIDTH, BENCH_HEIGHT))) {
+        return 0;
+    }
+    shell_init(&bench_shell, NULL, &bench_st, &bench_gfx, CONSOLE_SINKS_DEFAULT);
+
+    bench_bmp24 = bench_make_bmp(BENCH_WIDTH, BENCH_HEIGHT, 24, &bench_bmp24_size);
+    bench_bmp32 = bench_make_bmp(BENCH_WIDTH, BENCH_HEIGHT, 32, &bench_bmp32_size);
+    return bench_bmp24 != NULL && bench_bmp32 != NULL;
+}
+
+// ---- Benchmarks ---------------------------------------------------------
+
+static void bench_fill_screen(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        gfx_fill_rect(&bench_gfx, 0, 0, BENCH_WIDTH, BENCH_HEIGHT, (UINT32)i);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_fill_small(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        gfx_fill_rect(&bench_gfx, (i * 8) % (BENCH_WIDTH - 8), (i * 16) % (BENCH_HEIGHT - 16), 8, 16, (UINT32)i);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_glyph_char(UINT64 iterations) {
+    UINTN cols = BENCH_WIDTH / FONT_CHAR_WIDTH;
+    for (UINT64 i = 0; i < iterations; i++) {
+        UINTN cell = (UINTN)(i % (cols * 40));
+        font_draw_char(&bench_gfx, (cell % cols) * FONT_CHAR_WIDTH, (cell / cols) * FONT_CHAR_HEIGHT,
+                       (char)(33 + i % 94), 0xE8E8E8, 0x10161E, 1, FALSE);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_glyph_run(UINT64 iterations) {
+    const char *text = BENCH_TEXT_LINE;
+    UINTN len = u_strlen(text);
+    for (UINT64 i = 0; i < iterations; i++) {
+        font_draw_run(&bench_gfx, 0, (i % 40) * FONT_CHAR_HEIGHT, text, len, 0xE8E8E8, 0x10161E);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_scroll_copy(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        gfx_copy_rect(&bench_gfx, 0, FONT_CHAR_HEIGHT, 0, 0, BENCH_WIDTH, BENCH_HEIGHT - FONT_CHAR_HEIGHT);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+// One printed line that scrolls the screen, repainted and presented the way
+// the shell does before it waits for input.
+static void bench_shell_line(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        shell_println(&bench_shell, BENCH_TEXT_LINE);
+        shell_sync_screen(&bench_shell);
+        gfx_present(&bench_gfx);
+    }
+}
+
+static void bench_present_full(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        gfx_mark_dirty(&bench_gfx, 0, 0, BENCH_WIDTH, BENCH_HEIGHT);
+        gfx_present(&bench_gfx);
+    }
+}
+
+static void bench_bmp_row24(UINT64 iterations) {
+    UINTN row_bytes = (BENCH_WIDTH * 3 + 3) & ~(UINTN)3;
+    for (UINT64 i = 0; i < iterations; i++) {
+        UINTN y = (UINTN)(i % BENCH_HEIGHT);
+        gfx_blit_bmp_row(&bench_gfx, bench_bmp24 + 54 + y * row_bytes, 3, 0, y, BENCH_WIDTH);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_bmp_row32(UINT64 iterations) {
+    for (UINT64 i = 0; i < iterations; i++) {
+        UINTN y = (UINTN)(i % BENCH_HEIGHT);
+        gfx_blit_bmp_row(&bench_gfx, bench_bmp32 + 54 + y * BENCH_WIDTH * 4, 4, 0, y, BENCH_WIDTH);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_bmp_decode(UINT64 iterations) {
+    BenchFile file;
+    for (UINT64 i = 0; i < iterations; i++) {
+        bench_file_init(&file, bench_bmp24, bench_bmp24_size);
+        bench_sink += image_draw_file(&bench_st, &bench_gfx, &file.proto, NULL);
+    }
+    bench_gfx.dirty_count = 0;
+}
+
+static void bench_u64_to_dec(UINT64 iterations) {
+    char buf[32];
+    for (UINT64 i = 0; i < iterations; i++) {
+        u_u64_to_dec(i * 2654435761ULL, buf, sizeof(buf));
+        bench_sink += (UINT8)buf[0];
+    }
+}
+
+static void bench_u64_to_hex(UINT64 iterations) {
+    char buf[32];
+    for (UINT64 i = 0; i < iterations; i++) {
+        u_u64_to_hex(i * 2654435761ULL, buf, sizeof(buf));
+        bench_sink += (UINT8)buf[2];
+    }
+}
+
+static void bench_normalize_path(UINT64 iterations) {
+    static const char *inputs[] = {
+        "a.txt",
+        "../x/./y/../z.bin",
+        "/HATTEROS/system/config/shell.cfg",
+        "docs/../../EFI/BOOT/BOOTX64.EFI",
+    };
+    char out[SHELL_PATH_MAX];
+    for (UINT64 i = 0; i < iterations; i++) {
+        bench_sink += shell_normalize_path("\\HATTEROS\\user\\home", inputs[i % 4], out, sizeof(out));
+    }
+}
+
+static const BenchCase bench_cases[] = {
+    {"fill_screen", bench_fill_screen, BENCH_WIDTH * BENCH_HEIGHT, "px"},
+    {"fill_cell", bench_fill_small, FONT_CHAR_WIDTH * FONT_CHAR_HEIGHT, "px"},
+    {"glyph_char", bench_glyph_char, 1, "glyph"},
+    {"glyph_run", bench_glyph_run, sizeof(BENCH_TEXT_LINE) - 1, "glyph"},
+    {"scroll_copy_rect", bench_scroll_copy, BENCH_WIDTH * (BENCH_HEIGHT - FONT_CHAR_HEIGHT), "px"},
+    {"shell_line_scroll", bench_shell_line, 1, "line"},
+    {"present_full", bench_present_full, BENCH_WIDTH * BENCH_HEIGHT, "px"},
+    {"bmp_row_24", bench_bmp_row24, BENCH_WIDTH, "px"},
+    {"bmp_row_32", bench_bmp_row32, BENCH_WIDTH, "px"},
+    {"bmp_decode_24", bench_bmp_decode, BENCH_WIDTH * BENCH_HEIGHT, "px"},
+    {"u64_to_dec", bench_u64_to_dec, 1, "call"},
+    {"u64_to_hex", bench_u64_to_hex, 1, "call"},
+    {"normalize_path", bench_normalize_path, 1, "call"},
+};
+
+// Double the iteration count until one timed pass lasts BENCH_MIN_NS.
+static void bench_run(const BenchCase *bc, FILE *out) {
+    UINT64 iterations = 1;
+    UINT64 elapsed = 0;
+    bc->fn(1);
+    while (1) {
+        UINT64 start = bench_now_ns();
+        bc->fn(iterations);
+        elapsed = bench_now_ns() - start;
+        if (elapsed >= BENCH_MIN_NS || iterations >= (1ULL << 40)) {
+            break;
+        }
+        iterations *= 2;
+    }
+
+    double ns_per_op = (double)elapsed / (double)iterations;
+    double units_per_sec = (double)bc->units_per_op * 1e9 / ns_per_op;
+    printf("%-20s %12.1f ns/op %16.0f %s/s\n", bc->name, ns_per_op, units_per_sec, bc->unit);
+    if (out != NULL) {
+        fprintf(out, "%s,%s,%s,%s,%llu,%.1f,%.0f,%s\n", BENCH_GIT_REV, bc->name, bench_gfx.fill_kernel,
+                bench_gfx.bmp_kernel, (unsigned long long)iterations, ns_per_op, units_per_sec, bc->unit);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (!bench_setup()) {
+        fprintf(stderr, "bench: setup failed\n");
+        return 1;
+    }
+
+    FILE *out = NULL;
+    if (argc > 1) {
+        out = fopen(argv[1], "w");
+        if (out == NULL) {
+            perror(argv[1]);
+            return 1;
+        }
+        fprintf(out, "rev,name,fill_kernel,bmp_kernel,iterations,ns_per_op,units_per_sec,unit\n");
+    }
+
+    printf("HatterOS host bench, rev %s, %dx%d, fill %s, bmp %s\n", BENCH_GIT_REV, BENCH_WIDTH, BENCH_HEIGHT,
+           bench_gfx.fill_kernel, bench_gfx.bmp_kernel);
+    for (UINTN i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); i++) {
+        bench_run(&bench_cases[i], out);
+    }
+
+    if (out != NULL) {
+        fclose(out);
+        printf("Results written to %s\n", argv[1]);
+    }
+    return 0;
+}
@@ -0,0 +1,432 @@
+// Host stand-in for the GNU-EFI headers, used only by `make bench`.
+// Declares just the types, constants and protocol layouts the HatterOS sources
+// touch. Firmware calls become plain function calls; bench.c supplies RAM-backed
+// implementations of the services it needs.
+#ifndef HATTEROS_BENCH_EFI_H
+#define HATTEROS_BENCH_EFI_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t UINT8;
+typedef uint16_t UINT16;
+typedef uint32_t UINT32;
+typedef uint64_t UINT64;
+typedef int8_t INT8;
+typedef int16_t INT16;
+typedef int32_t INT32;
+typedef int64_t INT64;
+typedef uint64_t UINTN;
+typedef int64_t INTN;
+typedef UINT8 BOOLEAN;
+typedef uint16_t CHAR16;
+typedef char CHAR8;
+typedef void VOID;
+typedef UINTN EFI_STATUS;
+typedef void *EFI_HANDLE;
+typedef void *EFI_EVENT;
+typedef UINT64 EFI_PHYSICAL_ADDRESS;
+typedef UINT64 EFI_VIRTUAL_ADDRESS;
+typedef UINTN EFI_TPL;
+
+#define TRUE ((BOOLEAN)1)
+#define FALSE ((BOOLEAN)0)
+#define IN
+#define OUT
+#define OPTIONAL
+#define EFIAPI
+
+#define EFI_ERROR_BIT 0x8000000000000000ULL
+#define EFIERR(a) (EFI_ERROR_BIT | (a))
+#define EFI_ERROR(a) (((INTN)(a)) < 0)
+
+#define EFI_SUCCESS 0
+#define EFI_LOAD_ERROR EFIERR(1)
+#define EFI_INVALID_PARAMETER EFIERR(2)
+#define EFI_UNSUPPORTED EFIERR(3)
+#define EFI_BAD_BUFFER_SIZE EFIERR(4)
+#define EFI_BUFFER_TOO_SMALL EFIERR(5)
+#define EFI_NOT_READY EFIERR(6)
+#define EFI_DEVICE_ERROR EFIERR(7)
+#define EFI_WRITE_PROTECTED EFIERR(8)
+#define EFI_OUT_OF_RESOURCES EFIERR(9)
+#define EFI_VOLUME_CORRUPTED EFIERR(10)
+#define EFI_VOLUME_FULL EFIERR(11)
+#define EFI_NO_MEDIA EFIERR(12)
+#define EFI_MEDIA_CHANGED EFIERR(13)
+#define EFI_NOT_FOUND EFIERR(14)
+#define EFI_ACCESS_DENIED EFIERR(15)
+#define EFI_NO_RESPONSE EFIERR(16)
+#define EFI_NO_MAPPING EFIERR(17)
+#define EFI_TIMEOUT EFIERR(18)
+#define EFI_NOT_STARTED EFIERR(19)
+#define EFI_ALREADY_STARTED EFIERR(20)
+#define EFI_ABORTED EFIERR(21)
+#define EFI_END_OF_FILE EFIERR(31)
+
+typedef struct {
+    UINT32 Data1;
+    UINT16 Data2;
+    UINT16 Data3;
+    UINT8 Data4[8];
+} EFI_GUID;
+
+#define EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID {0x9042a9de, 0x23dc, 0x4a38, {0x96, 0xfb, 0x7a, 0xde, 0xd0, 0x80, 0x51, 0x6a}}
+#define EFI_LOADED_IMAGE_PROTOCOL_GUID {0x5b1b31a1, 0x9562, 0x11d2, {0x8e, 0x3f, 0x00, 0xa0, 0xc9, 0x69, 0x72, 0x3b}}
+#define EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_GUID {0x964e5b22, 0x6459, 0x11d2, {0x8e, 0x39, 0x00, 0xa0, 0xc9, 0x69, 0x72, 0x3b}}
+#define EFI_FILE_INFO_ID {0x09576e92, 0x6d3f, 0x11d2, {0x8e, 0x39, 0x00, 0xa0, 0xc9, 0x69, 0x72, 0x3b}}
+#define EFI_SERIAL_IO_PROTOCOL_GUID {0xbb25cf6f, 0xf1d4, 0x11d2, {0x9a, 0x0c, 0x00, 0x90, 0x27, 0x3f, 0xc1, 0xfd}}
+
+typedef enum {
+    AllHandles,
+    ByRegisterNotify,
+    ByProtocol
+} EFI_LOCATE_SEARCH_TYPE;
+
+typedef enum {
+    AllocateAnyPages,
+    AllocateMaxAddress,
+    AllocateAddress,
+    MaxAllocateType
+} EFI_ALLOCATE_TYPE;
+
+typedef enum {
+    EfiReservedMemoryType,
+    EfiLoaderCode,
+    EfiLoaderData,
+    EfiBootServicesCode,
+    EfiBootServicesData,
+    EfiRuntimeServicesCode,
+    EfiRuntimeServicesData,
+    EfiConventionalMemory,
+    EfiUnusableMemory,
+    EfiACPIReclaimMemory,
+    EfiACPIMemoryNVS,
+    EfiMemoryMappedIO,
+    EfiMemoryMappedIOPortSpace,
+    EfiPalCode,
+    EfiMaxMemoryType
+} EFI_MEMORY_TYPE;
+
+typedef struct {
+    UINT32 Type;
+    UINT32 Pad;
+    EFI_PHYSICAL_ADDRESS PhysicalStart;
+    EFI_VIRTUAL_ADDRESS VirtualStart;
+    UINT64 NumberOfPages;
+    UINT64 Attribute;
+} EFI_MEMORY_DESCRIPTOR;
+
+typedef enum {
+    TimerCancel,
+    TimerPeriodic,
+    TimerRelative
+} EFI_TIMER_DELAY;
+
+typedef enum {
+    EfiResetCold,
+    EfiResetWarm,
+    EfiResetShutdown
+} EFI_RESET_TYPE;
+
+#define EVT_TIMER 0x80000000
+#define EVT_NOTIFY_SIGNAL 0x00000200
+#define TPL_APPLICATION 4
+#define TPL_CALLBACK 8
+#define TPL_NOTIFY 16
+
+typedef void (*EFI_EVENT_NOTIFY)(EFI_EVENT event, void *context);
+
+typedef struct {
+    UINT16 Year;
+    UINT8 Month;
+    UINT8 Day;
+    UINT8 Hour;
+    UINT8 Minute;
+    UINT8 Second;
+    UINT8 Pad1;
+    UINT32 Nanosecond;
+    INT16 TimeZone;
+    UINT8 Daylight;
+    UINT8 Pad2;
+} EFI_TIME;
+
+typedef struct {
+    UINT32 Resolution;
+    UINT32 Accuracy;
+    BOOLEAN SetsToZero;
+} EFI_TIME_CAPABILITIES;
+
+typedef struct {
+    UINT64 Signature;
+    UINT32 Revision;
+    UINT32 HeaderSize;
+    UINT32 CRC32;
+    UINT32 Reserved;
+} EFI_TABLE_HEADER;
+
+// Graphics output
+typedef enum {
+    PixelRedGreenBlueReserved8BitPerColor,
+    PixelBlueGreenRedReserved8BitPerColor,
+    PixelBitMask,
+    PixelBltOnly,
+    PixelFormatMax
+} EFI_GRAPHICS_PIXEL_FORMAT;
+
+typedef struct {
+    UINT32 RedMask;
+    UINT32 GreenMask;
+    UINT32 BlueMask;
+    UINT32 ReservedMask;
+} EFI_PIXEL_BITMASK;
+
+typedef struct {
+    UINT32 Version;
+    UINT32 HorizontalResolution;
+    UINT32 VerticalResolution;
+    EFI_GRAPHICS_PIXEL_FORMAT PixelFormat;
+    EFI_PIXEL_BITMASK PixelInformation;
+    UINT32 PixelsPerScanLine;
+} EFI_GRAPHICS_OUTPUT_MODE_INFORMATION;
+
+typedef struct {
+    UINT32 MaxMode;
+    UINT32 Mode;
+    EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *Info;
+    UINTN SizeOfInfo;
+    EFI_PHYSICAL_ADDRESS FrameBufferBase;
+    UINTN FrameBufferSize;
+} EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE;
+
+typedef struct {
+    UINT8 Blue;
+    UINT8 Green;
+    UINT8 Red;
+    UINT8 Reserved;
+} EFI_GRAPHICS_OUTPUT_BLT_PIXEL;
+
+typedef enum {
+    EfiBltVideoFill,
+    EfiBltVideoToBltBuffer,
+    EfiBltBufferToVideo,
+    EfiBltVideoToVideo,
+    EfiGraphicsOutputBltOperationMax
+} EFI_GRAPHICS_OUTPUT_BLT_OPERATION;
+
+typedef struct _EFI_GRAPHICS_OUTPUT_PROTOCOL {
+    EFI_STATUS (*QueryMode)(struct _EFI_GRAPHICS_OUTPUT_PROTOCOL *self, UINT32 mode, UINTN *size, EFI_GRAPHICS_OUTPUT_MODE_INFORMATION **info);
+    EFI_STATUS (*SetMode)(struct _EFI_GRAPHICS_OUTPUT_PROTOCOL *self, UINT32 mode);
+    EFI_STATUS (*Blt)(struct _EFI_GRAPHICS_OUTPUT_PROTOCOL *self, EFI_GRAPHICS_OUTPUT_BLT_PIXEL *buffer,
+                      EFI_GRAPHICS_OUTPUT_BLT_OPERATION op, UINTN src_x, UINTN src_y, UINTN dst_x, UINTN dst_y,
+                      UINTN w, UINTN h, UINTN delta);
+    EFI_GRAPHICS_OUTPUT_PROTOCOL_MODE *Mode;
+} EFI_GRAPHICS_OUTPUT_PROTOCOL;
+
+// Console text I/O
+typedef struct {
+    UINT16 ScanCode;
+    CHAR16 UnicodeChar;
+} EFI_INPUT_KEY;
+
+#define SCAN_NULL 0x00
+#define SCAN_UP 0x01
+#define SCAN_DOWN 0x02
+#define SCAN_RIGHT 0x03
+#define SCAN_LEFT 0x04
+#define SCAN_HOME 0x05
+#define SCAN_END 0x06
+#define SCAN_INSERT 0x07
+#define SCAN_DELETE 0x08
+#define SCAN_PAGE_UP 0x09
+#define SCAN_PAGE_DOWN 0x0A
+#define SCAN_F1 0x0B
+#define SCAN_ESC 0x17
+
+typedef struct _SIMPLE_INPUT_INTERFACE {
+    EFI_STATUS (*Reset)(struct _SIMPLE_INPUT_INTERFACE *self, BOOLEAN extended);
+    EFI_STATUS (*ReadKeyStroke)(struct _SIMPLE_INPUT_INTERFACE *self, EFI_INPUT_KEY *key);
+    EFI_EVENT WaitForKey;
+} SIMPLE_INPUT_INTERFACE, EFI_SIMPLE_TEXT_IN_PROTOCOL;
+
+typedef struct _SIMPLE_TEXT_OUTPUT_INTERFACE {
+    EFI_STATUS (*Reset)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, BOOLEAN extended);
+    EFI_STATUS (*OutputString)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, CHAR16 *text);
+    EFI_STATUS (*TestString)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, CHAR16 *text);
+    EFI_STATUS (*QueryMode)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, UINTN mode, UINTN *cols, UINTN *rows);
+    EFI_STATUS (*SetMode)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, UINTN mode);
+    EFI_STATUS (*SetAttribute)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, UINTN attr);
+    EFI_STATUS (*ClearScreen)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self);
+    EFI_STATUS (*SetCursorPosition)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, UINTN col, UINTN row);
+    EFI_STATUS (*EnableCursor)(struct _SIMPLE_TEXT_OUTPUT_INTERFACE *self, BOOLEAN visible);
+    void *Mode;
+} SIMPLE_TEXT_OUTPUT_INTERFACE, EFI_SIMPLE_TEXT_OUT_PROTOCOL;
+
+// Files
+#define EFI_FILE_MODE_READ 0x0000000000000001ULL
+#define EFI_FILE_MODE_WRITE 0x0000000000000002ULL
+#define EFI_FILE_MODE_CREATE 0x8000000000000000ULL
+#define EFI_FILE_READ_ONLY 0x01ULL
+#define EFI_FILE_DIRECTORY 0x10ULL
+
+typedef struct _EFI_FILE_PROTOCOL {
+    UINT64 Revision;
+    EFI_STATUS (*Open)(struct _EFI_FILE_PROTOCOL *self, struct _EFI_FILE_PROTOCOL **out, CHAR16 *name, UINT64 mode, UINT64 attrs);
+    EFI_STATUS (*Close)(struct _EFI_FILE_PROTOCOL *self);
+    EFI_STATUS (*Delete)(struct _EFI_FILE_PROTOCOL *self);
+    EFI_STATUS (*Read)(struct _EFI_FILE_PROTOCOL *self, UINTN *size, VOID *buf);
+    EFI_STATUS (*Write)(struct _EFI_FILE_PROTOCOL *self, UINTN *size, VOID *buf);
+    EFI_STATUS (*GetPosition)(struct _EFI_FILE_PROTOCOL *self, UINT64 *pos);
+    EFI_STATUS (*SetPosition)(struct _EFI_FILE_PROTOCOL *self, UINT64 pos);
+    EFI_STATUS (*GetInfo)(struct _EFI_FILE_PROTOCOL *self, EFI_GUID *type, UINTN *size, VOID *buf);
+    EFI_STATUS (*SetInfo)(struct _EFI_FILE_PROTOCOL *self, EFI_GUID *type, UINTN size, VOID *buf);
+    EFI_STATUS (*Flush)(struct _EFI_FILE_PROTOCOL *self);
+} EFI_FILE_PROTOCOL, EFI_FILE, *EFI_FILE_HANDLE;
+
+typedef struct {
+    UINT64 Size;
+    UINT64 FileSize;
+    UINT64 PhysicalSize;
+    EFI_TIME CreateTime;
+    EFI_TIME LastAccessTime;
+    EFI_TIME ModificationTime;
+    UINT64 Attribute;
+    CHAR16 FileName[1];
+} EFI_FILE_INFO;
+
+#define SIZE_OF_EFI_FILE_INFO offsetof(EFI_FILE_INFO, FileName)
+
+typedef struct _EFI_SIMPLE_FILE_SYSTEM_PROTOCOL {
+    UINT64 Revision;
+    EFI_STATUS (*OpenVolume)(struct _EFI_SIMPLE_FILE_SYSTEM_PROTOCOL *self, EFI_FILE_PROTOCOL **root);
+} EFI_SIMPLE_FILE_SYSTEM_PROTOCOL;
+
+typedef struct {
+    UINT32 Revision;
+    EFI_HANDLE ParentHandle;
+    void *SystemTable;
+    EFI_HANDLE DeviceHandle;
+    void *FilePath;
+    void *Reserved;
+    UINT32 LoadOptionsSize;
+    void *LoadOptions;
+    void *ImageBase;
+    UINT64 ImageSize;
+    EFI_MEMORY_TYPE ImageCodeType;
+    EFI_MEMORY_TYPE ImageDataType;
+    void *Unload;
+} EFI_LOADED_IMAGE;
+
+// Serial
+typedef enum {
+    DefaultParity,
+    NoParity,
+    EvenParity,
+    OddParity
+} EFI_PARITY_TYPE;
+
+typedef enum {
+    DefaultStopBits,
+    OneStopBit,
+    OneFiveStopBits,
+    TwoStopBits
+} EFI_STOP_BITS_TYPE;
+
+typedef struct _SERIAL_IO_INTERFACE {
+    UINT32 Revision;
+    EFI_STATUS (*Reset)(struct _SERIAL_IO_INTERFACE *self);
+    EFI_STATUS (*SetAttributes)(struct _SERIAL_IO_INTERFACE *self, UINT64 baud, UINT32 fifo, UINT32 timeout,
+                                EFI_PARITY_TYPE parity, UINT8 data_bits, EFI_STOP_BITS_TYPE stop_bits);
+    EFI_STATUS (*SetControl)(struct _SERIAL_IO_INTERFACE *self, UINT32 control);
+    EFI_STATUS (*GetControl)(struct _SERIAL_IO_INTERFACE *self, UINT32 *control);
+    EFI_STATUS (*Write)(struct _SERIAL_IO_INTERFACE *self, UINTN *size, VOID *buf);
+    EFI_STATUS (*Read)(struct _SERIAL_IO_INTERFACE *self, UINTN *size, VOID *buf);
+    void *Mode;
+} SERIAL_IO_INTERFACE, EFI_SERIAL_IO_PROTOCOL;
+
+// System tables. Services HatterOS never calls are left as opaque pointers.
+typedef struct {
+    EFI_TABLE_HEADER Hdr;
+    EFI_STATUS (*GetTime)(EFI_TIME *time, EFI_TIME_CAPABILITIES *caps);
+    void *SetTime;
+    void *GetWakeupTime;
+    void *SetWakeupTime;
+    void *SetVirtualAddressMap;
+    void *ConvertPointer;
+    void *GetVariable;
+    void *GetNextVariableName;
+    void *SetVariable;
+    void *GetNextHighMonotonicCount;
+    void (*ResetSystem)(EFI_RESET_TYPE type, EFI_STATUS status, UINTN size, CHAR16 *data);
+} EFI_RUNTIME_SERVICES;
+
+typedef struct {
+    EFI_TABLE_HEADER Hdr;
+    EFI_TPL (*RaiseTPL)(EFI_TPL tpl);
+    void (*RestoreTPL)(EFI_TPL tpl);
+    EFI_STATUS (*AllocatePages)(EFI_ALLOCATE_TYPE type, EFI_MEMORY_TYPE mem, UINTN pages, EFI_PHYSICAL_ADDRESS *addr);
+    EFI_STATUS (*FreePages)(EFI_PHYSICAL_ADDRESS addr, UINTN pages);
+    EFI_STATUS (*GetMemoryMap)(UINTN *size, EFI_MEMORY_DESCRIPTOR *map, UINTN *key, UINTN *desc_size, UINT32 *desc_version);
+    EFI_STATUS (*AllocatePool)(EFI_MEMORY_TYPE mem, UINTN size, VOID **out);
+    EFI_STATUS (*FreePool)(VOID *ptr);
+    EFI_STATUS (*CreateEvent)(UINT32 type, EFI_TPL tpl, EFI_EVENT_NOTIFY notify, VOID *context, EFI_EVENT *event);
+    EFI_STATUS (*SetTimer)(EFI_EVENT event, EFI_TIMER_DELAY type, UINT64 trigger);
+    EFI_STATUS (*WaitForEvent)(UINTN count, EFI_EVENT *events, UINTN *index);
+    EFI_STATUS (*SignalEvent)(EFI_EVENT event);
+    EFI_STATUS (*CloseEvent)(EFI_EVENT event);
+    EFI_STATUS (*CheckEvent)(EFI_EVENT event);
+    void *InstallProtocolInterface;
+    void *ReinstallProtocolInterface;
+    void *UninstallProtocolInterface;
+    EFI_STATUS (*HandleProtocol)(EFI_HANDLE handle, EFI_GUID *guid, VOID **out);
+    void *PCHandleProtocol;
+    void *RegisterProtocolNotify;
+    EFI_STATUS (*LocateHandle)(EFI_LOCATE_SEARCH_TYPE type, EFI_GUID *guid, VOID *key, UINTN *size, EFI_HANDLE *out);
+    void *LocateDevicePath;
+    void *InstallConfigurationTable;
+    void *LoadImage;
+    void *StartImage;
+    void *Exit;
+    void *UnloadImage;
+    void *ExitBootServices;
+    void *GetNextMonotonicCount;
+    EFI_STATUS (*Stall)(UINTN microseconds);
+    void *SetWatchdogTimer;
+    void *ConnectController;
+    void *DisconnectController;
+    void *OpenProtocol;
+    void *CloseProtocol;
+    void *OpenProtocolInformation;
+    void *ProtocolsPerHandle;
+    EFI_STATUS (*LocateHandleBuffer)(EFI_LOCATE_SEARCH_TYPE type, EFI_GUID *guid, VOID *key, UINTN *count, EFI_HANDLE **out);
+    EFI_STATUS (*LocateProtocol)(EFI_GUID *guid, VOID *registration, VOID **out);
+    void *InstallMultipleProtocolInterfaces;
+    void *UninstallMultipleProtocolInterfaces;
+    void *CalculateCrc32;
+    void (*CopyMem)(VOID *dst, VOID *src, UINTN size);
+    void (*SetMem)(VOID *dst, UINTN size, UINT8 value);
+} EFI_BOOT_SERVICES;
+
+typedef struct {
+    EFI_TABLE_HEADER Hdr;
+    CHAR16 *FirmwareVendor;
+    UINT32 FirmwareRevision;
+    EFI_HANDLE ConsoleInHandle;
+    SIMPLE_INPUT_INTERFACE *ConIn;
+    EFI_HANDLE ConsoleOutHandle;
+    SIMPLE_TEXT_OUTPUT_INTERFACE *ConOut;
+    EFI_HANDLE StandardErrorHandle;
+    SIMPLE_TEXT_OUTPUT_INTERFACE *StdErr;
+    EFI_RUNTIME_SERVICES *RuntimeServices;
+    EFI_BOOT_SERVICES *BootServices;
+    UINTN NumberOfTableEntries;
+    void *ConfigurationTable;
+} EFI_SYSTEM_TABLE;
+
+#define EFI_PAGE_SIZE 4096
+#define EFI_SIZE_TO_PAGES(a) (((a) >> 12) + (((a) & 0xFFF) ? 1 : 0))
+
+// Host calls use the native ABI, so the GNU-EFI thunk is just a direct call.
+#define uefi_call_wrapper(func, va_num, ...) func(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,2 @@
+// Host stand-in for GNU-EFI's efilib.h; see efi.h.
+#include <efi.h>
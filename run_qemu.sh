@@ -58,8 +58,12 @@ seed_default_hatteros_tree() {
 }
 
 prepare_auto_splash() {
-  # If a BMP already exists in common locations, keep it.
+  # If a QOI/BMP already exists in common locations, keep it.
   local bmp_candidates=(
+    "$ESP_FILES_DIR/EFI/BOOT/SPLASH.QOI"
+    "$ESP_FILES_DIR/EFI/BOOT/splash.qoi"
+    "$ESP_FILES_DIR/SPLASH.QOI"
+    "$ESP_FILES_DIR/splash.qoi"
     "$ESP_FILES_DIR/EFI/BOOT/SPLASH.BMP"
     "$ESP_FILES_DIR/EFI/BOOT/splash.bmp"
     "$ESP_FILES_DIR/SPLASH.BMP"
@@ -72,7 +76,8 @@ prepare_auto_splash() {
     fi
   done
 
-  # Otherwise accept png/jpg and convert host-side to BOOT splash BMP.
+  # Otherwise accept png/jpg and convert host-side to BOOT splash QOI (or BMP
+  # when the installed ImageMagick has no QOI coder).
   local src_candidates=(
     "$ESP_FILES_DIR/EFI/BOOT/splash.png"
     "$ESP_FILES_DIR/EFI/BOOT/SPLASH.PNG"
@@ -99,20 +104,29 @@ prepare_auto_splash() {
     return
   fi
 
-  local out="$BUILD_DIR/auto_splash.bmp"
-  # Keep generated BMP reasonably small so FAT image copy stays quick.
-  # ">" means only shrink if source is larger than target bounds.
+  local im=""
   if command -v magick >/dev/null 2>&1; then
-    magick "$src" -resize "1024x768>" -type TrueColor -alpha off BMP3:"$out"
+    im="magick"
   elif command -v convert >/dev/null 2>&1; then
-    convert "$src" -resize "1024x768>" -type TrueColor -alpha off BMP3:"$out"
+    im="convert"
   else
     echo "Found splash source ($src) but no ImageMagick tool (magick/convert). Skipping auto-convert." >&2
     return
   fi
 
-  echo "Auto-converted splash asset: ${src#$ROOT_DIR/} -> EFI/BOOT/SPLASH.BMP"
-  mcopy -i "$ESP_IMG" -D o "$out" ::/EFI/BOOT/SPLASH.BMP >/dev/null
+  # Keep full resolution; HatterOS scales oversized images to the GOP mode.
+  local fmt="BMP"
+  local out="$BUILD_DIR/auto_splash.bmp"
+  if "$im" -list format 2>/dev/null | grep -q "^ *QOI"; then
+    fmt="QOI"
+    out="$BUILD_DIR/auto_splash.qoi"
+    "$im" "$src" -alpha off QOI:"$out"
+  else
+    "$im" "$src" -type TrueColor -alpha off BMP3:"$out"
+  fi
+
+  echo "Auto-converted splash asset: ${src#$ROOT_DIR/} -> EFI/BOOT/SPLASH.$fmt"
+  mcopy -i "$ESP_IMG" -D o "$out" ::/EFI/BOOT/SPLASH.$fmt >/dev/null
 }
 
 copy_extra_esp_files() {
@@ -152,9 +166,15 @@ copy_extra_esp_files() {
 }
 
 main() {
+  local headless=0
+  local display="default"
   if [[ "${1:-}" == "--minimal" ]]; then
     EFI_BIN="$BUILD_DIR/BOOTX64_MIN.EFI"
     MAKE_TARGET="minimal"
+  elif [[ "${1:-}" == "--headless" ]]; then
+    # Shell text on the serial port (this terminal), no window, no rendering.
+    headless=1
+    display="none"
   fi
 
   mkdir -p "$BUILD_DIR"
@@ -217,6 +237,11 @@ main() {
   seed_default_hatteros_tree
   prepare_auto_splash
 
+  if [[ "$headless" == 1 ]]; then
+    printf 'serial\n' > "$BUILD_DIR/console.cfg"
+    mcopy -i "$ESP_IMG" -D o "$BUILD_DIR/console.cfg" ::/HATTEROS/system/config/console.cfg >/dev/null
+  fi
+
   cp "$ovmf_vars_src" "$OVMF_VARS_WORK"
 
   echo "Using OVMF CODE: $ovmf_code"
@@ -226,7 +251,7 @@ main() {
     -machine q35,accel=tcg \
     -m 512M \
     -serial stdio \
-    -display default \
+    -display "$display" \
     -drive if=pflash,format=raw,readonly=on,file="$ovmf_code" \
     -drive if=pflash,format=raw,file="$OVMF_VARS_WORK" \
     -drive format=raw,file="$ESP_IMG"
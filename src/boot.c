@@ -0,0 +1,55 @@
+#include "boot.h"
+#include "cpu.h"
+#include "evlog.h"
+
+static UINT64 boot_stamps[BOOT_PHASE_COUNT];
+
+static const char *const boot_phase_names[BOOT_PHASE_COUNT] = {
+    "firmware",
+    "conin reset",
+    "gfx init",
+    "splash draw",
+    "splash wait",
+    "shell init",
+    "settings load",
+    "first prompt",
+};
+
+// Record the end of `phase`. Only the first mark counts, so call sites that
+// can run more than once (the prompt) keep the boot-time value.
+void boot_mark(BootPhase phase) {
+    if (phase < BOOT_PHASE_COUNT && boot_stamps[phase] == 0) {
+        boot_stamps[phase] = cpu_rdtsc();
+        evlog_write(EVLOG_SYS_BOOT, EVLOG_LEVEL_INFO, EVLOG_BOOT_PHASE, phase, boot_phase_cycles(phase));
+    }
+}
+
+UINT64 boot_stamp(BootPhase phase) {
+    return (phase < BOOT_PHASE_COUNT) ? boot_stamps[phase] : 0;
+}
+
+// Cycles spent in `phase`. The entry phase is everything before efi_main,
+// which is the raw TSC since reset on parts where firmware does not reset it.
+// Returns 0 when either end of the phase was not marked.
+UINT64 boot_phase_cycles(BootPhase phase) {
+    if (phase >= BOOT_PHASE_COUNT || boot_stamps[phase] == 0) {
+        return 0;
+    }
+    if (phase == BOOT_PHASE_ENTRY) {
+        return boot_stamps[phase];
+    }
+    UINT64 prev = boot_stamps[phase - 1];
+    return (prev != 0 && boot_stamps[phase] > prev) ? boot_stamps[phase] - prev : 0;
+}
+
+const char *boot_phase_name(BootPhase phase) {
+    return (phase < BOOT_PHASE_COUNT) ? boot_phase_names[phase] : "?";
+}
+
+UINT64 boot_cycles_to_us(UINT64 cycles, UINT64 tsc_hz) {
+    if (tsc_hz == 0) {
+        return 0;
+    }
+    // Split to avoid overflowing cycles * 1e6 on long uptimes.
+    return (cycles / tsc_hz) * 1000000ULL + ((cycles % tsc_hz) * 1000000ULL) / tsc_hz;
+}
@@ -0,0 +1,26 @@
+#ifndef HATTEROS_BOOT_H
+#define HATTEROS_BOOT_H
+
+#include <efi.h>
+
+// Boot phases in the order efi_main runs them. Each mark is the TSC value at
+// the end of that phase; BOOT_PHASE_ENTRY is taken on entry to efi_main.
+typedef enum {
+    BOOT_PHASE_ENTRY = 0,
+    BOOT_PHASE_CONIN_RESET,
+    BOOT_PHASE_GFX_INIT,
+    BOOT_PHASE_SPLASH,
+    BOOT_PHASE_SPLASH_WAIT,
+    BOOT_PHASE_SHELL_INIT,
+    BOOT_PHASE_SETTINGS,
+    BOOT_PHASE_PROMPT,
+    BOOT_PHASE_COUNT
+} BootPhase;
+
+void boot_mark(BootPhase phase);
+UINT64 boot_stamp(BootPhase phase);
+UINT64 boot_phase_cycles(BootPhase phase);
+const char *boot_phase_name(BootPhase phase);
+UINT64 boot_cycles_to_us(UINT64 cycles, UINT64 tsc_hz);
+
+#endif
@@ -0,0 +1,172 @@
+#include "console.h"
+#include "util.h"
+
+// Characters converted per ConOut call.
+#define CONSOLE_CHUNK 128
+
+typedef struct {
+    const char *name;
+    UINT32 bit;
+    void (*write)(Console *con, const char *text, UINTN n);
+} ConsoleSinkOps;
+
+static void console_conout_write(Console *con, const char *text, UINTN n);
+static void console_serial_write(Console *con, const char *text, UINTN n);
+static void console_log_write(Console *con, const char *text, UINTN n);
+
+// The framebuffer entry has no writer: the shell draws that sink itself.
+static const ConsoleSinkOps console_sink_ops[] = {
+    {"framebuffer", CONSOLE_SINK_FRAMEBUFFER, NULL},
+    {"conout", CONSOLE_SINK_CONOUT, console_conout_write},
+    {"serial", CONSOLE_SINK_SERIAL, console_serial_write},
+    {"log", CONSOLE_SINK_LOG, console_log_write},
+};
+
+#define CONSOLE_SINK_COUNT (sizeof(console_sink_ops) / sizeof(console_sink_ops[0]))
+
+void console_init(Console *con, EFI_SYSTEM_TABLE *st, UINT32 sinks) {
+    con->st = st;
+    con->log = NULL;
+    con->log_len = 0;
+
+    // Without a serial device, a headless console falls back to ConOut; the
+    // default framebuffer+serial set just loses its mirror.
+    if ((sinks & CONSOLE_SINK_SERIAL) != 0 && !serial_available()) {
+        sinks &= ~CONSOLE_SINK_SERIAL;
+        if ((sinks & CONSOLE_SINK_FRAMEBUFFER) == 0) {
+            sinks |= CONSOLE_SINK_CONOUT;
+        }
+    }
+    if ((sinks & CONSOLE_SINK_CONOUT) != 0 && st->ConOut == NULL) {
+        sinks &= ~CONSOLE_SINK_CONOUT;
+    }
+    con->sinks = sinks & ~CONSOLE_SINK_LOG;
+}
+
+void console_attach_log(Console *con, EFI_FILE_PROTOCOL *file) {
+    con->log = file;
+    con->log_len = 0;
+    if (file != NULL) {
+        con->sinks |= CONSOLE_SINK_LOG;
+    }
+}
+
+void console_write(Console *con, const char *text, UINTN n) {
+    for (UINTN i = 0; i < CONSOLE_SINK_COUNT; i++) {
+        if ((con->sinks & console_sink_ops[i].bit) != 0 && console_sink_ops[i].write != NULL) {
+            console_sink_ops[i].write(con, text, n);
+        }
+    }
+}
+
+void console_flush(Console *con) {
+    if ((con->sinks & CONSOLE_SINK_SERIAL) != 0) {
+        serial_flush();
+    }
+    if ((con->sinks & CONSOLE_SINK_LOG) == 0 || con->log == NULL || con->log_len == 0) {
+        return;
+    }
+    UINTN size = con->log_len;
+    uefi_call_wrapper(con->log->Write, 3, con->log, &size, con->log_buf);
+    uefi_call_wrapper(con->log->Flush, 1, con->log);
+    con->log_len = 0;
+}
+
+// Text terminals want CRLF; the shell emits bare '\n'.
+static void console_conout_write(Console *con, const char *text, UINTN n) {
+    CHAR16 buf[CONSOLE_CHUNK + 2];
+    UINTN len = 0;
+    for (UINTN i = 0; i < n; i++) {
+        if (text[i] == '\n') {
+            buf[len++] = L'\r';
+        }
+        buf[len++] = (CHAR16)(UINT8)text[i];
+        if (len >= CONSOLE_CHUNK || i + 1 == n) {
+            buf[len] = 0;
+            uefi_call_wrapper(con->st->ConOut->OutputString, 2, con->st->ConOut, buf);
+            len = 0;
+        }
+    }
+}
+
+// Queued in the serial ring (util.c); no firmware call on this path.
+static void console_serial_write(Console *con, const char *text, UINTN n) {
+    (void)con;
+    serial_write_n(text, n);
+}
+
+static void console_log_write(Console *con, const char *text, UINTN n) {
+    for (UINTN i = 0; i < n; i++) {
+        if (con->log_len == CONSOLE_LOG_BUF) {
+            UINTN size = con->log_len;
+            uefi_call_wrapper(con->log->Write, 3, con->log, &size, con->log_buf);
+            con->log_len = 0;
+        }
+        con->log_buf[con->log_len++] = text[i];
+    }
+}
+
+BOOLEAN console_parse_sinks(const char *text, UINTN len, UINT32 *out) {
+    UINT32 sinks = 0;
+    UINTN i = 0;
+    while (i < len) {
+        while (i < len && (text[i] == ' ' || text[i] == ',' || text[i] == '\t' || text[i] == '\r' || text[i] == '\n')) {
+            i++;
+        }
+        UINTN start = i;
+        while (i < len && text[i] != ' ' && text[i] != ',' && text[i] != '\t' && text[i] != '\r' && text[i] != '\n') {
+            i++;
+        }
+        UINTN word_len = i - start;
+        if (word_len == 0) {
+            continue;
+        }
+
+        BOOLEAN known = (word_len == 4 && u_strncmp(&text[start], "null", 4) == 0);
+        for (UINTN s = 0; s < CONSOLE_SINK_COUNT && !known; s++) {
+            const char *name = console_sink_ops[s].name;
+            if (u_strlen(name) == word_len && u_strncmp(&text[start], name, word_len) == 0) {
+                sinks |= console_sink_ops[s].bit;
+                known = TRUE;
+            }
+        }
+        if (!known) {
+            return FALSE;
+        }
+    }
+    *out = sinks;
+    return TRUE;
+}
+
+static void console_append(char *out, UINTN out_len, UINTN *pos, const char *text) {
+    while (*text != '\0' && *pos + 1 < out_len) {
+        out[(*pos)++] = *text++;
+    }
+    out[*pos] = '\0';
+}
+
+void console_describe(UINT32 sinks, char *out, UINTN out_len) {
+    if (out_len == 0) {
+        return;
+    }
+    UINTN pos = 0;
+    out[0] = '\0';
+    for (UINTN s = 0; s < CONSOLE_SINK_COUNT; s++) {
+        if ((sinks & console_sink_ops[s].bit) != 0) {
+            console_append(out, out_len, &pos, (pos > 0) ? "+" : "");
+            console_append(out, out_len, &pos, console_sink_ops[s].name);
+        }
+    }
+    if (pos == 0) {
+        console_append(out, out_len, &pos, "null");
+    }
+}
+
+// H on the splash screen boots headless: shell text goes to the serial port
+// only and nothing is rasterized.
+UINT32 console_sinks_for_key(CHAR16 key) {
+    if (key == L'h' || key == L'H') {
+        return CONSOLE_SINK_SERIAL;
+    }
+    return CONSOLE_SINKS_AUTO;
+}
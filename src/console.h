@@ -0,0 +1,53 @@
+#ifndef HATTEROS_CONSOLE_H
+#define HATTEROS_CONSOLE_H
+
+#include <efi.h>
+
+// Console sinks: where shell text goes. Any combination may be active; an
+// empty set is the null sink. The framebuffer sink is the shell's own
+// renderer; the others are written by console_write.
+#define CONSOLE_SINK_FRAMEBUFFER (1U << 0)
+#define CONSOLE_SINK_CONOUT (1U << 1)
+#define CONSOLE_SINK_SERIAL (1U << 2)
+#define CONSOLE_SINK_LOG (1U << 3)
+#define CONSOLE_SINKS_DEFAULT (CONSOLE_SINK_FRAMEBUFFER | CONSOLE_SINK_SERIAL)
+
+// Passed to shell_init when no boot key picked the sinks, so the config
+// file (or the default) decides.
+#define CONSOLE_SINKS_AUTO 0xFFFFFFFFU
+
+#define CONSOLE_LOG_BUF 4096
+
+typedef struct {
+    EFI_SYSTEM_TABLE *st;
+    UINT32 sinks;
+
+    // Log sink: an open file positioned at its end, written in
+    // CONSOLE_LOG_BUF chunks and on console_flush.
+    EFI_FILE_PROTOCOL *log;
+    char log_buf[CONSOLE_LOG_BUF];
+    UINTN log_len;
+} Console;
+
+// Select `sinks`. The serial sink needs serial_init to have found a device;
+// the log sink stays off until console_attach_log gives it a file.
+void console_init(Console *con, EFI_SYSTEM_TABLE *st, UINT32 sinks);
+void console_attach_log(Console *con, EFI_FILE_PROTOCOL *file);
+
+// Write n bytes to every active sink except the framebuffer.
+void console_write(Console *con, const char *text, UINTN n);
+
+// Push buffered sink output to its device. Called before blocking on input.
+void console_flush(Console *con);
+
+// Parse sink names ("framebuffer", "conout", "serial", "log", "null")
+// separated by spaces, commas or newlines. Returns FALSE on an unknown name.
+BOOLEAN console_parse_sinks(const char *text, UINTN len, UINT32 *out);
+
+// Sink names joined with '+', or "null".
+void console_describe(UINT32 sinks, char *out, UINTN out_len);
+
+// Sinks chosen by a key pressed on the splash screen, or CONSOLE_SINKS_AUTO.
+UINT32 console_sinks_for_key(CHAR16 key);
+
+#endif
@@ -0,0 +1,84 @@
+#include "cpu.h"
+#include <cpuid.h>
+
+#define CPU_TSC_CALIBRATE_US 10000
+
+static BOOLEAN cpu_probed = FALSE;
+static UINT32 cpu_feature_bits = 0;
+static UINT64 cpu_tsc_rate = 0;
+
+// XCR0 tells us which register states firmware has enabled for XSAVE.
+static UINT64 cpu_read_xcr0(void) {
+    UINT32 lo;
+    UINT32 hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((UINT64)hi << 32) | lo;
+}
+
+// Probe CPUID once and cache the result.
+// AVX2 also needs OSXSAVE + YMM state enabled in XCR0; UEFI firmware does not
+// always turn that on, in which case we stay on SSE paths.
+UINT32 cpu_features(void) {
+    if (cpu_probed) {
+        return cpu_feature_bits;
+    }
+    cpu_probed = TRUE;
+
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return cpu_feature_bits;
+    }
+
+    if (edx & bit_SSE2) {
+        cpu_feature_bits |= CPU_FEATURE_SSE2;
+    }
+    if (ecx & bit_SSSE3) {
+        cpu_feature_bits |= CPU_FEATURE_SSSE3;
+    }
+
+    BOOLEAN ymm_enabled = FALSE;
+    if ((ecx & bit_OSXSAVE) != 0) {
+        ymm_enabled = (cpu_read_xcr0() & 0x6) == 0x6;
+    }
+
+    if (ymm_enabled && __get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx) && (ebx & bit_AVX2) != 0) {
+        cpu_feature_bits |= CPU_FEATURE_AVX2;
+    }
+
+    return cpu_feature_bits;
+}
+
+BOOLEAN cpu_has(UINT32 feature) {
+    return (cpu_features() & feature) == feature;
+}
+
+UINT64 cpu_rdtsc(void) {
+    UINT32 lo;
+    UINT32 hi;
+    __asm__ volatile ("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((UINT64)hi << 32) | lo;
+}
+
+// TSC ticks per second, computed once. CPUID leaf 0x15 gives the exact ratio
+// on recent Intel parts; otherwise (AMD, most hypervisors) time a short Stall.
+UINT64 cpu_tsc_hz(EFI_BOOT_SERVICES *bs) {
+    if (cpu_tsc_rate != 0) {
+        return cpu_tsc_rate;
+    }
+
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0, NULL) >= 0x15 && __get_cpuid(0x15, &eax, &ebx, &ecx, &edx) &&
+        eax != 0 && ebx != 0 && ecx != 0) {
+        cpu_tsc_rate = (UINT64)ecx * ebx / eax;
+        return cpu_tsc_rate;
+    }
+
+    if (bs == NULL) {
+        return 0;
+    }
+    UINT64 start = cpu_rdtsc();
+    uefi_call_wrapper(bs->Stall, 1, CPU_TSC_CALIBRATE_US);
+    UINT64 end = cpu_rdtsc();
+    cpu_tsc_rate = (end - start) * (1000000ULL / CPU_TSC_CALIBRATE_US);
+    return cpu_tsc_rate;
+}
@@ -0,0 +1,15 @@
+#ifndef HATTEROS_CPU_H
+#define HATTEROS_CPU_H
+
+#include <efi.h>
+
+#define CPU_FEATURE_SSE2  (1U << 0)
+#define CPU_FEATURE_SSSE3 (1U << 1)
+#define CPU_FEATURE_AVX2  (1U << 2)
+
+UINT32 cpu_features(void);
+BOOLEAN cpu_has(UINT32 feature);
+UINT64 cpu_rdtsc(void);
+UINT64 cpu_tsc_hz(EFI_BOOT_SERVICES *bs);
+
+#endif
@@ -0,0 +1,90 @@
+#include "evlog.h"
+#include "cpu.h"
+
+static EvlogRecord evlog_ring[EVLOG_RING_RECORDS];
+static UINT64 evlog_next = 0;
+static UINT64 evlog_flushed = 0;
+// One past the seq of the newest error record, 0 if none yet.
+static UINT64 evlog_error_end = 0;
+
+static const char *const evlog_subsystem_names[EVLOG_SYS_COUNT] = {
+    "log",
+    "boot",
+    "shell",
+    "file",
+};
+
+static const char *const evlog_event_names[EVLOG_EVENT_COUNT] = {
+    "dropped",
+    "phase",
+    "gop-failed",
+    "error",
+    "unknown-cmd",
+    "error",
+};
+
+void evlog_write(EvlogSubsystem subsystem, EvlogLevel level, EvlogEvent event, UINT64 arg0, UINT64 arg1) {
+    UINT64 seq = evlog_next++;
+    EvlogRecord *rec = &evlog_ring[seq % EVLOG_RING_RECORDS];
+    rec->tsc = cpu_rdtsc();
+    rec->arg0 = arg0;
+    rec->arg1 = arg1;
+    rec->seq = (UINT32)seq;
+    rec->subsystem = (UINT8)subsystem;
+    rec->level = (UINT8)level;
+    rec->event = (UINT16)event;
+    if (level == EVLOG_LEVEL_ERROR) {
+        evlog_error_end = seq + 1;
+    }
+}
+
+UINT64 evlog_tag(const char *text) {
+    UINT64 tag = 0;
+    for (UINTN i = 0; i < 8 && text != NULL && text[i] != '\0'; i++) {
+        tag |= (UINT64)(UINT8)text[i] << (i * 8);
+    }
+    return tag;
+}
+
+void evlog_untag(UINT64 tag, char out[9]) {
+    UINTN i = 0;
+    for (; i < 8; i++) {
+        char c = (char)((tag >> (i * 8)) & 0xFF);
+        if (c == '\0') {
+            break;
+        }
+        out[i] = (c >= 32 && c <= 126) ? c : '?';
+    }
+    out[i] = '\0';
+}
+
+UINT64 evlog_next_seq(void) {
+    return evlog_next;
+}
+
+const EvlogRecord *evlog_record(UINT64 seq) {
+    if (seq >= evlog_next || evlog_next - seq > EVLOG_RING_RECORDS) {
+        return NULL;
+    }
+    return &evlog_ring[seq % EVLOG_RING_RECORDS];
+}
+
+UINT64 evlog_flushed_seq(void) {
+    return evlog_flushed;
+}
+
+void evlog_mark_flushed(UINT64 seq) {
+    evlog_flushed = seq;
+}
+
+BOOLEAN evlog_error_pending(void) {
+    return evlog_error_end > evlog_flushed;
+}
+
+const char *evlog_subsystem_name(UINTN subsystem) {
+    return (subsystem < EVLOG_SYS_COUNT) ? evlog_subsystem_names[subsystem] : "?";
+}
+
+const char *evlog_event_name(UINTN event) {
+    return (event < EVLOG_EVENT_COUNT) ? evlog_event_names[event] : "?";
+}
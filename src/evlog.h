@@ -0,0 +1,78 @@
+#ifndef HATTEROS_EVLOG_H
+#define HATTEROS_EVLOG_H
+
+#include <efi.h>
+
+// Structured event log: a RAM ring of fixed-size binary records. Writing one
+// is a TSC read and a handful of stores; the shell appends new records to
+// SHELL_EVENT_LOG_PATH from the prompt and `log` decodes them.
+#define EVLOG_RING_RECORDS 1024
+#define EVLOG_FILE_MAGIC 0x4C564548U // "HEVL"
+#define EVLOG_FILE_VERSION 1U
+
+typedef enum {
+    EVLOG_SYS_LOG = 0,
+    EVLOG_SYS_BOOT,
+    EVLOG_SYS_SHELL,
+    EVLOG_SYS_FILE,
+    EVLOG_SYS_COUNT
+} EvlogSubsystem;
+
+typedef enum {
+    EVLOG_LEVEL_INFO = 0,
+    EVLOG_LEVEL_ERROR
+} EvlogLevel;
+
+// Event ids, with what arg0/arg1 hold.
+typedef enum {
+    EVLOG_LOG_DROPPED = 0,  // records overwritten before a flush, -
+    EVLOG_BOOT_PHASE,       // BootPhase, cycles spent in it
+    EVLOG_BOOT_GOP_FAILED,  // EFI_STATUS, -
+    EVLOG_SHELL_ERROR,      // EFI_STATUS, evlog_tag of the message prefix
+    EVLOG_SHELL_UNKNOWN,    // -, evlog_tag of the command name
+    EVLOG_FILE_ERROR,       // EFI_STATUS, evlog_tag of the protocol method
+    EVLOG_EVENT_COUNT
+} EvlogEvent;
+
+// 32 bytes, written to disk as-is.
+typedef struct {
+    UINT64 tsc;
+    UINT64 arg0;
+    UINT64 arg1;
+    UINT32 seq;
+    UINT8 subsystem;
+    UINT8 level;
+    UINT16 event;
+} EvlogRecord;
+
+// First 32 bytes of the log file.
+typedef struct {
+    UINT32 magic;
+    UINT16 version;
+    UINT16 record_size;
+    UINT8 reserved[24];
+} EvlogFileHeader;
+
+void evlog_write(EvlogSubsystem subsystem, EvlogLevel level, EvlogEvent event, UINT64 arg0, UINT64 arg1);
+
+// Up to 8 characters of `text` packed into a u64, so a short label fits in
+// a record arg; evlog_untag reverses it.
+UINT64 evlog_tag(const char *text);
+void evlog_untag(UINT64 tag, char out[9]);
+
+// Records are numbered from 0 in write order. evlog_record returns NULL
+// once `seq` has been overwritten (or not written yet).
+UINT64 evlog_next_seq(void);
+const EvlogRecord *evlog_record(UINT64 seq);
+
+// Flush bookkeeping for the shell: records from evlog_flushed_seq() up to
+// evlog_next_seq() are not on disk yet; evlog_error_pending says whether
+// one of them is an error.
+UINT64 evlog_flushed_seq(void);
+void evlog_mark_flushed(UINT64 seq);
+BOOLEAN evlog_error_pending(void);
+
+const char *evlog_subsystem_name(UINTN subsystem);
+const char *evlog_event_name(UINTN event);
+
+#endif
@@ -87,32 +87,218 @@ static const UINT8 *lookup_glyph(char ch) {
     }
 }
 
+// One pre-expanded glyph row: 8 native pixels, copied as a single block.
+typedef struct {
+    UINT32 px[FONT_CHAR_WIDTH];
+} FontCacheRow;
+
+// Glyphs pre-rendered for one (fg, bg) pair in native pixel format.
+// Entries are filled lazily; a different color pair (theme change, or any
+// caller using other colors) drops every entry.
+typedef struct {
+    BOOLEAN have_key;
+    UINT32 fg_native;
+    UINT32 bg_native;
+    BOOLEAN valid[FONT_CACHE_GLYPHS];
+    FontCacheRow rows[FONT_CACHE_GLYPHS][8];
+} FontGlyphCache;
+
+static FontGlyphCache glyph_cache;
+
+static const FontCacheRow *glyph_cache_lookup(UINT8 code) {
+    if (code >= FONT_CACHE_GLYPHS) {
+        code = 0;
+    }
+    FontCacheRow *rows = glyph_cache.rows[code];
+    if (!glyph_cache.valid[code]) {
+        const UINT8 *glyph = lookup_glyph((char)code);
+        for (UINTN gy = 0; gy < 8; gy++) {
+            for (UINTN gx = 0; gx < FONT_CHAR_WIDTH; gx++) {
+                BOOLEAN set = (glyph[gy] & (1U << (7 - gx))) != 0;
+                rows[gy].px[gx] = set ? glyph_cache.fg_native : glyph_cache.bg_native;
+            }
+        }
+        glyph_cache.valid[code] = TRUE;
+    }
+    return rows;
+}
+
+void font_cache_invalidate(void) {
+    glyph_cache.have_key = FALSE;
+    for (UINTN i = 0; i < FONT_CACHE_GLYPHS; i++) {
+        glyph_cache.valid[i] = FALSE;
+    }
+}
+
+// Horizontal runs of set bits in one 8-bit glyph row (at most 4 runs).
+typedef struct {
+    UINT8 count;
+    UINT8 start[4];
+    UINT8 len[4];
+} FontRowRuns;
+
+// Scale-independent run lists per glyph. Scaling multiplies start/len, so one
+// entry serves every scale and never needs invalidating.
+typedef struct {
+    BOOLEAN valid[FONT_CACHE_GLYPHS];
+    FontRowRuns rows[FONT_CACHE_GLYPHS][8];
+} FontRunCache;
+
+static FontRunCache run_cache;
+
+static const FontRowRuns *glyph_runs_lookup(UINT8 code) {
+    if (code >= FONT_CACHE_GLYPHS) {
+        code = 0;
+    }
+    FontRowRuns *rows = run_cache.rows[code];
+    if (!run_cache.valid[code]) {
+        const UINT8 *glyph = lookup_glyph((char)code);
+        for (UINTN gy = 0; gy < 8; gy++) {
+            FontRowRuns *runs = &rows[gy];
+            runs->count = 0;
+            UINTN gx = 0;
+            while (gx < 8) {
+                if ((glyph[gy] & (1U << (7 - gx))) == 0) {
+                    gx++;
+                    continue;
+                }
+                UINTN start = gx;
+                while (gx < 8 && (glyph[gy] & (1U << (7 - gx))) != 0) {
+                    gx++;
+                }
+                runs->start[runs->count] = (UINT8)start;
+                runs->len[runs->count] = (UINT8)(gx - start);
+                runs->count++;
+            }
+        }
+        run_cache.valid[code] = TRUE;
+    }
+    return rows;
+}
+
+// Key the glyph cache to this color pair, dropping entries for any other pair.
+static void glyph_cache_prepare(const GfxContext *ctx, UINT32 fg, UINT32 bg) {
+    UINT32 fg_native = gfx_native_color(ctx, fg);
+    UINT32 bg_native = gfx_native_color(ctx, bg);
+    if (!glyph_cache.have_key || glyph_cache.fg_native != fg_native || glyph_cache.bg_native != bg_native) {
+        font_cache_invalidate();
+        glyph_cache.have_key = TRUE;
+        glyph_cache.fg_native = fg_native;
+        glyph_cache.bg_native = bg_native;
+    }
+}
+
+// Fast path for the common shell case: scale 1, opaque, fully on-screen.
+// Each cached row is stored twice (8x8 -> 8x16) with whole-row copies.
+static BOOLEAN font_draw_char_cached(GfxContext *ctx, UINTN x, UINTN y, char ch, UINT32 fg, UINT32 bg) {
+    if (x + FONT_CHAR_WIDTH > ctx->width || y + FONT_CHAR_HEIGHT > ctx->height) {
+        return FALSE;
+    }
+
+    glyph_cache_prepare(ctx, fg, bg);
+    const FontCacheRow *rows = glyph_cache_lookup((UINT8)ch);
+    UINT32 *dst = ctx->pixels + y * ctx->stride + x;
+    for (UINTN gy = 0; gy < 8; gy++) {
+        *(FontCacheRow *)dst = rows[gy];
+        dst += ctx->stride;
+        *(FontCacheRow *)dst = rows[gy];
+        dst += ctx->stride;
+    }
+    gfx_mark_dirty(ctx, x, y, FONT_CHAR_WIDTH, FONT_CHAR_HEIGHT);
+    return TRUE;
+}
+
 // Draw one character at (x, y).
 // Each source row is duplicated vertically so the effective cell is 8x16.
 void font_draw_char(GfxContext *ctx, UINTN x, UINTN y, char ch, UINT32 fg, UINT32 bg, UINTN scale, BOOLEAN transparent_bg) {
     if (scale == 0) {
         scale = 1;
     }
+    ctx->counters.glyphs++;
+    ctx->counters.glyph_pixels += (UINT64)FONT_CHAR_WIDTH * FONT_CHAR_HEIGHT * scale * scale;
 
-    const UINT8 *glyph = lookup_glyph(ch);
+    if (scale == 1 && !transparent_bg && font_draw_char_cached(ctx, x, y, ch, fg, bg)) {
+        return;
+    }
 
+    if (!transparent_bg) {
+        gfx_fill_rect(ctx, x, y, FONT_CHAR_WIDTH * scale, FONT_CHAR_HEIGHT * scale, bg);
+    }
+    if (x >= ctx->width || y >= ctx->height) {
+        return;
+    }
+
+    // Every glyph row covers 2*scale scanlines (8x8 -> 8x16); each foreground
+    // run becomes one span fill per scanline instead of scale x scale rects.
+    UINT32 fg_native = gfx_native_color(ctx, fg);
+    const FontRowRuns *runs = glyph_runs_lookup((UINT8)ch);
     for (UINTN gy = 0; gy < 8; gy++) {
-        UINT8 row = glyph[gy];
-        for (UINTN gx = 0; gx < 8; gx++) {
-            BOOLEAN set = (row & (1U << (7 - gx))) != 0;
-            UINT32 color = set ? fg : bg;
-            if (!set && transparent_bg) {
-                continue;
+        UINTN y0 = y + gy * 2 * scale;
+        if (y0 >= ctx->height) {
+            break;
+        }
+        UINTN y1 = y0 + 2 * scale;
+        if (y1 > ctx->height) {
+            y1 = ctx->height;
+        }
+
+        for (UINTN r = 0; r < runs[gy].count; r++) {
+            UINTN x0 = x + runs[gy].start[r] * scale;
+            if (x0 >= ctx->width) {
+                break;
+            }
+            UINTN w = runs[gy].len[r] * scale;
+            if (w > ctx->width - x0) {
+                w = ctx->width - x0;
             }
+            for (UINTN yy = y0; yy < y1; yy++) {
+                ctx->fill_span(ctx->pixels + yy * ctx->stride + x0, w, fg_native);
+            }
+        }
+    }
+    gfx_mark_dirty(ctx, x, y, FONT_CHAR_WIDTH * scale, FONT_CHAR_HEIGHT * scale);
+}
+
+// Draw `len` opaque scale-1 cells as one batch.
+// Output is produced scanline by scanline across the whole run, so each of the
+// 16 destination rows is written once, left to right, and one dirty rect
+// covers the run. Runs that do not fit on screen fall back to per-glyph draws.
+void font_draw_run(GfxContext *ctx, UINTN x, UINTN y, const char *text, UINTN len, UINT32 fg, UINT32 bg) {
+    if (len == 0) {
+        return;
+    }
+    if (y + FONT_CHAR_HEIGHT > ctx->height || x > ctx->width || len > (ctx->width - x) / FONT_CHAR_WIDTH) {
+        for (UINTN i = 0; i < len; i++) {
+            font_draw_char(ctx, x + i * FONT_CHAR_WIDTH, y, text[i], fg, bg, 1, FALSE);
+        }
+        return;
+    }
+
+    glyph_cache_prepare(ctx, fg, bg);
+    ctx->counters.glyphs += len;
+    ctx->counters.glyph_pixels += (UINT64)len * FONT_CHAR_WIDTH * FONT_CHAR_HEIGHT;
 
-            UINTN draw_y = y + (gy * 2 * scale);
-            UINTN draw_x = x + (gx * scale);
+    const FontCacheRow *glyphs[FONT_RUN_MAX];
+    for (UINTN done = 0; done < len; done += FONT_RUN_MAX) {
+        UINTN n = ((len - done) > FONT_RUN_MAX) ? FONT_RUN_MAX : (len - done);
+        for (UINTN i = 0; i < n; i++) {
+            glyphs[i] = glyph_cache_lookup((UINT8)text[done + i]);
+        }
 
-            // Render each source row twice so an 8x8 glyph becomes 8x16.
-            gfx_fill_rect(ctx, draw_x, draw_y, scale, scale, color);
-            gfx_fill_rect(ctx, draw_x, draw_y + scale, scale, scale, color);
+        UINT32 *dst = ctx->pixels + y * ctx->stride + x + done * FONT_CHAR_WIDTH;
+        for (UINTN gy = 0; gy < 8; gy++) {
+            FontCacheRow *top = (FontCacheRow *)dst;
+            FontCacheRow *bottom = (FontCacheRow *)(dst + ctx->stride);
+            for (UINTN i = 0; i < n; i++) {
+                top[i] = glyphs[i][gy];
+            }
+            for (UINTN i = 0; i < n; i++) {
+                bottom[i] = glyphs[i][gy];
+            }
+            dst += ctx->stride * 2;
         }
     }
+    gfx_mark_dirty(ctx, x, y, len * FONT_CHAR_WIDTH, FONT_CHAR_HEIGHT);
 }
 
 // Draw a null-terminated text string using fixed-width cells.
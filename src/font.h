@@ -6,9 +6,13 @@
 
 #define FONT_CHAR_WIDTH 8
 #define FONT_CHAR_HEIGHT 16
+#define FONT_CACHE_GLYPHS 128
+#define FONT_RUN_MAX 256
 
 void font_draw_char(GfxContext *ctx, UINTN x, UINTN y, char ch, UINT32 fg, UINT32 bg, UINTN scale, BOOLEAN transparent_bg);
+void font_draw_run(GfxContext *ctx, UINTN x, UINTN y, const char *text, UINTN len, UINT32 fg, UINT32 bg);
 void font_draw_text(GfxContext *ctx, UINTN x, UINTN y, const char *text, UINT32 fg, UINT32 bg, UINTN scale, BOOLEAN transparent_bg);
 UINTN font_text_width(const char *text, UINTN scale);
+void font_cache_invalidate(void);
 
 #endif
\ No newline at end of file
@@ -1,23 +1,323 @@
 #include "gfx.h"
+#include "cpu.h"
+#include "trace.h"
 #include <efilib.h>
 
+// GCC vector types; intrinsic headers pull in libc headers we cannot use here.
+typedef UINT32 GfxVec4 __attribute__((vector_size(16)));
+typedef long long GfxVec2q __attribute__((vector_size(16)));
+typedef UINT32 GfxVec8 __attribute__((vector_size(32)));
+typedef long long GfxVec4q __attribute__((vector_size(32)));
+typedef char GfxVec16b __attribute__((vector_size(16)));
+typedef char GfxVec16bu __attribute__((vector_size(16), aligned(1), may_alias));
+
 // Helper for "closest resolution" scoring.
 static UINTN abs_diff(UINTN a, UINTN b) {
     return (a > b) ? (a - b) : (b - a);
 }
 
 // Input colors in this codebase are stored as 0xRRGGBB.
-// GOP framebuffers can be RGB or BGR, so convert before writing.
+// GOP framebuffers can be BGRx, RGBx or an arbitrary bitmask layout. Each
+// layout gets its own pack/convert pair generated from one expression, so
+// inner loops carry no per-pixel format branch.
+#define GFX_DEFINE_FORMAT(fmt_name, PACK_EXPR)                                                   \
+    static UINT32 pack_##fmt_name(const GfxContext *ctx, UINT32 rgb) {                           \
+        (void)ctx;                                                                               \
+        return (PACK_EXPR);                                                                      \
+    }                                                                                            \
+    static void convert_row_##fmt_name(const GfxContext *ctx, UINT32 *dst, const UINT32 *src, UINTN count) { \
+        (void)ctx;                                                                               \
+        for (UINTN i = 0; i < count; i++) {                                                      \
+            UINT32 rgb = src[i];                                                                 \
+            dst[i] = (PACK_EXPR);                                                                \
+        }                                                                                        \
+    }                                                                                            \
+    static void convert_bmp_row_##fmt_name(const GfxContext *ctx, UINT32 *dst, const UINT8 *src, UINTN count, UINTN bytes_per_pixel) { \
+        (void)ctx;                                                                               \
+        for (UINTN i = 0; i < count; i++, src += bytes_per_pixel) {                              \
+            UINT32 rgb = ((UINT32)src[2] << 16) | ((UINT32)src[1] << 8) | src[0];                \
+            dst[i] = (PACK_EXPR);                                                                \
+        }                                                                                        \
+    }                                                                                            \
+    static const GfxFormatOps format_##fmt_name = {                                             \
+        #fmt_name, pack_##fmt_name, convert_row_##fmt_name, convert_bmp_row_##fmt_name          \
+    };
+
+static inline UINT32 pack_channel(const GfxChannel *ch, UINT32 c) {
+    return ((c >> ch->rshift) << ch->lshift) & ch->mask;
+}
+
+GFX_DEFINE_FORMAT(bgrx, rgb & 0xFFFFFF)
+GFX_DEFINE_FORMAT(rgbx, ((rgb & 0xFF) << 16) | (rgb & 0xFF00) | ((rgb >> 16) & 0xFF))
+GFX_DEFINE_FORMAT(
+    bitmask,
+    pack_channel(&ctx->red, (rgb >> 16) & 0xFF) |
+    pack_channel(&ctx->green, (rgb >> 8) & 0xFF) |
+    pack_channel(&ctx->blue, rgb & 0xFF)
+)
+
 static UINT32 to_native_color(const GfxContext *ctx, UINT32 rgb) {
-    UINT32 r = (rgb >> 16) & 0xFF;
-    UINT32 g = (rgb >> 8) & 0xFF;
-    UINT32 b = rgb & 0xFF;
+    return ctx->format->pack(ctx, rgb);
+}
+
+static void setup_channel(GfxChannel *ch, UINT32 mask) {
+    UINTN low = 0;
+    UINTN width = 0;
+    ch->mask = mask;
+    if (mask != 0) {
+        while ((mask & (1U << low)) == 0) {
+            low++;
+        }
+        while (low + width < 32 && (mask & (1U << (low + width))) != 0) {
+            width++;
+        }
+    }
+    ch->rshift = (UINT8)((width < 8) ? (8 - width) : 0);
+    ch->lshift = (UINT8)(low + ((width > 8) ? (width - 8) : 0));
+}
+
+// Only 32-bit pixels are supported; a bitmask mode qualifies when some mask
+// bit sits in the top byte (the spec sizes the pixel by the highest bit set).
+static BOOLEAN bitmask_is_32bit(const EFI_PIXEL_BITMASK *m) {
+    UINT32 all = m->RedMask | m->GreenMask | m->BlueMask | m->ReservedMask;
+    return m->RedMask != 0 && m->GreenMask != 0 && m->BlueMask != 0 && (all >> 24) != 0;
+}
+
+static BOOLEAN mode_supported(const EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *info) {
+    switch (info->PixelFormat) {
+    case PixelBlueGreenRedReserved8BitPerColor:
+    case PixelRedGreenBlueReserved8BitPerColor:
+        return TRUE;
+    case PixelBitMask:
+        return bitmask_is_32bit(&info->PixelInformation);
+    default:
+        return FALSE;
+    }
+}
+
+static void select_format(GfxContext *ctx, const EFI_GRAPHICS_OUTPUT_MODE_INFORMATION *info) {
+    if (info->PixelFormat == PixelRedGreenBlueReserved8BitPerColor) {
+        ctx->format = &format_rgbx;
+    } else if (info->PixelFormat == PixelBitMask) {
+        setup_channel(&ctx->red, info->PixelInformation.RedMask);
+        setup_channel(&ctx->green, info->PixelInformation.GreenMask);
+        setup_channel(&ctx->blue, info->PixelInformation.BlueMask);
+        ctx->format = &format_bitmask;
+    } else {
+        ctx->format = &format_bgrx;
+    }
+}
+
+// Public wrapper so renderers that write the surface directly can pre-convert.
+UINT32 gfx_native_color(const GfxContext *ctx, UINT32 rgb) {
+    return to_native_color(ctx, rgb);
+}
+
+static void span_fill_scalar(UINT32 *dst, UINTN count, UINT32 native) {
+    for (UINTN i = 0; i < count; i++) {
+        dst[i] = native;
+    }
+}
+
+// SSE2 span fills. Scalar head until 16-byte aligned, then 64 bytes per loop.
+static void span_fill_sse2(UINT32 *dst, UINTN count, UINT32 native) {
+    GfxVec4 v = { native, native, native, native };
+    UINTN i = 0;
+    while (i < count && ((UINTN)(dst + i) & 15) != 0) {
+        dst[i++] = native;
+    }
+    for (; i + 16 <= count; i += 16) {
+        *(GfxVec4 *)(dst + i) = v;
+        *(GfxVec4 *)(dst + i + 4) = v;
+        *(GfxVec4 *)(dst + i + 8) = v;
+        *(GfxVec4 *)(dst + i + 12) = v;
+    }
+    for (; i + 4 <= count; i += 4) {
+        *(GfxVec4 *)(dst + i) = v;
+    }
+    for (; i < count; i++) {
+        dst[i] = native;
+    }
+}
 
-    if (ctx->pixel_format == PixelRedGreenBlueReserved8BitPerColor) {
-        return (b << 16) | (g << 8) | r;
+// Non-temporal variant for write-combined video memory: bypasses the cache so
+// a full-screen clear streams at bus speed instead of polluting L1/L2.
+static void span_fill_sse2_nt(UINT32 *dst, UINTN count, UINT32 native) {
+    GfxVec4 v = { native, native, native, native };
+    UINTN i = 0;
+    while (i < count && ((UINTN)(dst + i) & 15) != 0) {
+        dst[i++] = native;
     }
+    for (; i + 4 <= count; i += 4) {
+        __builtin_ia32_movntdq((GfxVec2q *)(dst + i), (GfxVec2q)v);
+    }
+    for (; i < count; i++) {
+        dst[i] = native;
+    }
+    __builtin_ia32_sfence();
+}
 
-    return (r << 16) | (g << 8) | b;
+__attribute__((target("avx2")))
+static void span_fill_avx2(UINT32 *dst, UINTN count, UINT32 native) {
+    GfxVec8 v = { native, native, native, native, native, native, native, native };
+    UINTN i = 0;
+    while (i < count && ((UINTN)(dst + i) & 31) != 0) {
+        dst[i++] = native;
+    }
+    for (; i + 32 <= count; i += 32) {
+        *(GfxVec8 *)(dst + i) = v;
+        *(GfxVec8 *)(dst + i + 8) = v;
+        *(GfxVec8 *)(dst + i + 16) = v;
+        *(GfxVec8 *)(dst + i + 24) = v;
+    }
+    for (; i + 8 <= count; i += 8) {
+        *(GfxVec8 *)(dst + i) = v;
+    }
+    for (; i < count; i++) {
+        dst[i] = native;
+    }
+    __builtin_ia32_vzeroupper();
+}
+
+__attribute__((target("avx2")))
+static void span_fill_avx2_nt(UINT32 *dst, UINTN count, UINT32 native) {
+    GfxVec8 v = { native, native, native, native, native, native, native, native };
+    UINTN i = 0;
+    while (i < count && ((UINTN)(dst + i) & 31) != 0) {
+        dst[i++] = native;
+    }
+    for (; i + 8 <= count; i += 8) {
+        __builtin_ia32_movntdq256((GfxVec4q *)(dst + i), (GfxVec4q)v);
+    }
+    for (; i < count; i++) {
+        dst[i] = native;
+    }
+    __builtin_ia32_sfence();
+    __builtin_ia32_vzeroupper();
+}
+
+// Pick the widest fill kernel the CPU supports. Streaming stores only pay off
+// when drawing straight into video memory; the back buffer is read again by
+// gfx_present, so it keeps normal cached stores.
+static void select_fill_kernel(GfxContext *ctx) {
+    BOOLEAN stream = !ctx->has_backbuffer;
+    if (cpu_has(CPU_FEATURE_AVX2)) {
+        ctx->fill_span = stream ? span_fill_avx2_nt : span_fill_avx2;
+        ctx->fill_kernel = stream ? "avx2-nt" : "avx2";
+    } else if (cpu_has(CPU_FEATURE_SSE2)) {
+        ctx->fill_span = stream ? span_fill_sse2_nt : span_fill_sse2;
+        ctx->fill_kernel = stream ? "sse2-nt" : "sse2";
+    } else {
+        ctx->fill_span = span_fill_scalar;
+        ctx->fill_kernel = "scalar";
+    }
+}
+
+// SSSE3 BMP row conversion: one pshufb turns 12 source bytes (24-bit) or 16
+// (32-bit) into four native pixels, zeroing the reserved byte. Loads never
+// reach past the last source pixel; the scalar back end finishes the tail.
+// Returns the number of pixels converted.
+__attribute__((target("ssse3")))
+static UINTN bmp_row_shuffle(UINT32 *dst, const UINT8 *src, UINTN count, UINTN bytes_per_pixel, GfxVec16b mask) {
+    UINTN i = 0;
+    if (bytes_per_pixel == 3) {
+        for (; i + 10 <= count; i += 8) {
+            GfxVec16b a = *(const GfxVec16bu *)(src + i * 3);
+            GfxVec16b b = *(const GfxVec16bu *)(src + i * 3 + 12);
+            *(GfxVec16bu *)(dst + i) = __builtin_ia32_pshufb128(a, mask);
+            *(GfxVec16bu *)(dst + i + 4) = __builtin_ia32_pshufb128(b, mask);
+        }
+        for (; i + 6 <= count; i += 4) {
+            GfxVec16b a = *(const GfxVec16bu *)(src + i * 3);
+            *(GfxVec16bu *)(dst + i) = __builtin_ia32_pshufb128(a, mask);
+        }
+    } else {
+        for (; i + 4 <= count; i += 4) {
+            GfxVec16b a = *(const GfxVec16bu *)(src + i * 4);
+            *(GfxVec16bu *)(dst + i) = __builtin_ia32_pshufb128(a, mask);
+        }
+    }
+    return i;
+}
+
+static void bmp_row_ssse3_bgrx(const GfxContext *ctx, UINT32 *dst, const UINT8 *src, UINTN count, UINTN bytes_per_pixel) {
+    static const GfxVec16b mask24 = { 0, 1, 2, -128, 3, 4, 5, -128, 6, 7, 8, -128, 9, 10, 11, -128 };
+    static const GfxVec16b mask32 = { 0, 1, 2, -128, 4, 5, 6, -128, 8, 9, 10, -128, 12, 13, 14, -128 };
+    UINTN done = bmp_row_shuffle(dst, src, count, bytes_per_pixel, (bytes_per_pixel == 3) ? mask24 : mask32);
+    convert_bmp_row_bgrx(ctx, dst + done, src + done * bytes_per_pixel, count - done, bytes_per_pixel);
+}
+
+static void bmp_row_ssse3_rgbx(const GfxContext *ctx, UINT32 *dst, const UINT8 *src, UINTN count, UINTN bytes_per_pixel) {
+    static const GfxVec16b mask24 = { 2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128 };
+    static const GfxVec16b mask32 = { 2, 1, 0, -128, 6, 5, 4, -128, 10, 9, 8, -128, 14, 13, 12, -128 };
+    UINTN done = bmp_row_shuffle(dst, src, count, bytes_per_pixel, (bytes_per_pixel == 3) ? mask24 : mask32);
+    convert_bmp_row_rgbx(ctx, dst + done, src + done * bytes_per_pixel, count - done, bytes_per_pixel);
+}
+
+// Byte shuffles only cover the two fixed layouts; PixelBitMask keeps the
+// scalar converter since its channels need shifts, not byte moves.
+static void select_bmp_kernel(GfxContext *ctx) {
+    ctx->bmp_row = ctx->format->convert_bmp_row;
+    ctx->bmp_kernel = "scalar";
+    if (!cpu_has(CPU_FEATURE_SSSE3)) {
+        return;
+    }
+    if (ctx->format == &format_bgrx) {
+        ctx->bmp_row = bmp_row_ssse3_bgrx;
+        ctx->bmp_kernel = "ssse3";
+    } else if (ctx->format == &format_rgbx) {
+        ctx->bmp_row = bmp_row_ssse3_rgbx;
+        ctx->bmp_kernel = "ssse3";
+    }
+}
+
+static EFI_GRAPHICS_OUTPUT_BLT_PIXEL to_blt_pixel(UINT32 rgb) {
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL px;
+    px.Red = (UINT8)((rgb >> 16) & 0xFF);
+    px.Green = (UINT8)((rgb >> 8) & 0xFF);
+    px.Blue = (UINT8)(rgb & 0xFF);
+    px.Reserved = 0;
+    return px;
+}
+
+// Thin GOP Blt wrapper. Returns FALSE when firmware rejects the operation so
+// callers can fall back to CPU copies.
+static BOOLEAN gop_blt(
+    GfxContext *ctx,
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL *buffer,
+    EFI_GRAPHICS_OUTPUT_BLT_OPERATION op,
+    UINTN src_x,
+    UINTN src_y,
+    UINTN dst_x,
+    UINTN dst_y,
+    UINTN w,
+    UINTN h,
+    UINTN delta
+) {
+    if (ctx->gop == NULL || ctx->gop->Blt == NULL) {
+        return FALSE;
+    }
+    EFI_STATUS status = uefi_call_wrapper(ctx->gop->Blt, 10, ctx->gop, buffer, op, src_x, src_y, dst_x, dst_y, w, h, delta);
+    return !EFI_ERROR(status);
+}
+
+// Move a rectangle inside one surface with memmove semantics for overlaps.
+static void copy_pixels(UINT32 *base, UINTN stride, UINTN src_x, UINTN src_y, UINTN dst_x, UINTN dst_y, UINTN w, UINTN h) {
+    BOOLEAN bottom_up = dst_y > src_y;
+    for (UINTN i = 0; i < h; i++) {
+        UINTN row = bottom_up ? (h - 1 - i) : i;
+        const UINT32 *src = base + (src_y + row) * stride + src_x;
+        UINT32 *dst = base + (dst_y + row) * stride + dst_x;
+        if (dst > src) {
+            for (UINTN x = w; x > 0; x--) {
+                dst[x - 1] = src[x - 1];
+            }
+        } else if (dst < src) {
+            for (UINTN x = 0; x < w; x++) {
+                dst[x] = src[x];
+            }
+        }
+    }
 }
 
 // Locate GOP, choose a reasonable mode, and cache framebuffer metadata.
@@ -58,8 +358,7 @@ EFI_STATUS gfx_init(EFI_SYSTEM_TABLE *st, GfxContext *ctx, UINTN target_w, UINTN
             continue;
         }
 
-        if (info->PixelFormat != PixelBlueGreenRedReserved8BitPerColor &&
-            info->PixelFormat != PixelRedGreenBlueReserved8BitPerColor) {
+        if (!mode_supported(info)) {
             uefi_call_wrapper(st->BootServices->FreePool, 1, info);
             continue;
         }
@@ -90,25 +389,164 @@ EFI_STATUS gfx_init(EFI_SYSTEM_TABLE *st, GfxContext *ctx, UINTN target_w, UINTN
     ctx->height = ctx->gop->Mode->Info->VerticalResolution;
     ctx->pixels_per_scanline = ctx->gop->Mode->Info->PixelsPerScanLine;
     ctx->pixel_format = ctx->gop->Mode->Info->PixelFormat;
+    if (!mode_supported(ctx->gop->Mode->Info)) {
+        return EFI_UNSUPPORTED;
+    }
+    select_format(ctx, ctx->gop->Mode->Info);
+
+    // Draw into a RAM shadow copy so primitives (and scroll, which reads pixels
+    // back) never touch uncached video memory. gfx_present flushes the damage.
+    ctx->pixels = ctx->framebuffer;
+    ctx->stride = ctx->pixels_per_scanline;
+    ctx->has_backbuffer = FALSE;
+    ctx->dirty_count = 0;
+    ctx->counters.glyphs = 0;
+    ctx->counters.glyph_pixels = 0;
+    ctx->counters.presents = 0;
+    ctx->counters.present_pixels = 0;
+
+    void *shadow = NULL;
+    UINTN shadow_size = ctx->width * ctx->height * sizeof(UINT32);
+    status = uefi_call_wrapper(st->BootServices->AllocatePool, 3, EfiLoaderData, shadow_size, &shadow);
+    if (!EFI_ERROR(status) && shadow != NULL) {
+        ctx->pixels = (UINT32 *)shadow;
+        ctx->stride = ctx->width;
+        ctx->has_backbuffer = TRUE;
+    }
+    select_fill_kernel(ctx);
+    select_bmp_kernel(ctx);
     return EFI_SUCCESS;
 }
 
+static UINTN rect_area(const GfxRect *r) {
+    return (r->x1 - r->x0) * (r->y1 - r->y0);
+}
+
+static void rect_union(GfxRect *dst, const GfxRect *src) {
+    if (src->x0 < dst->x0) {
+        dst->x0 = src->x0;
+    }
+    if (src->y0 < dst->y0) {
+        dst->y0 = src->y0;
+    }
+    if (src->x1 > dst->x1) {
+        dst->x1 = src->x1;
+    }
+    if (src->y1 > dst->y1) {
+        dst->y1 = src->y1;
+    }
+}
+
+// Record a damaged region. Once the table is full, the new rect is merged into
+// whichever existing rect grows the least, so flush cost stays bounded.
+void gfx_mark_dirty(GfxContext *ctx, UINTN x, UINTN y, UINTN w, UINTN h) {
+    if (!ctx->has_backbuffer || x >= ctx->width || y >= ctx->height || w == 0 || h == 0) {
+        return;
+    }
+
+    GfxRect r = { x, y, x + w, y + h };
+    if (r.x1 > ctx->width) {
+        r.x1 = ctx->width;
+    }
+    if (r.y1 > ctx->height) {
+        r.y1 = ctx->height;
+    }
+
+    for (UINTN i = 0; i < ctx->dirty_count; i++) {
+        GfxRect *d = &ctx->dirty[i];
+        if (r.x0 >= d->x0 && r.y0 >= d->y0 && r.x1 <= d->x1 && r.y1 <= d->y1) {
+            return;
+        }
+    }
+
+    if (ctx->dirty_count < GFX_DIRTY_MAX) {
+        ctx->dirty[ctx->dirty_count++] = r;
+        return;
+    }
+
+    UINTN best = 0;
+    UINTN best_growth = (UINTN)-1;
+    for (UINTN i = 0; i < ctx->dirty_count; i++) {
+        GfxRect merged = ctx->dirty[i];
+        rect_union(&merged, &r);
+        UINTN growth = rect_area(&merged) - rect_area(&ctx->dirty[i]);
+        if (growth < best_growth) {
+            best_growth = growth;
+            best = i;
+        }
+    }
+    rect_union(&ctx->dirty[best], &r);
+}
+
+// Copy every damaged region from the back buffer to video memory.
+// BGRx back buffers match the Blt pixel layout, so firmware Blt does the copy;
+// other layouts fall back to write-only row copies.
+void gfx_present(GfxContext *ctx) {
+    if (!ctx->has_backbuffer || ctx->dirty_count == 0) {
+        return;
+    }
+
+    trace_begin(TRACE_CAT_GFX, "present");
+    for (UINTN i = 0; i < ctx->dirty_count; i++) {
+        GfxRect *d = &ctx->dirty[i];
+        UINTN w = d->x1 - d->x0;
+        UINTN h = d->y1 - d->y0;
+        ctx->counters.presents++;
+        ctx->counters.present_pixels += (UINT64)w * h;
+
+        if (ctx->pixel_format == PixelBlueGreenRedReserved8BitPerColor &&
+            gop_blt(ctx, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)ctx->pixels, EfiBltBufferToVideo,
+                    d->x0, d->y0, d->x0, d->y0, w, h, ctx->stride * sizeof(UINT32))) {
+            continue;
+        }
+
+        for (UINTN y = d->y0; y < d->y1; y++) {
+            const UINT32 *src = ctx->pixels + y * ctx->stride + d->x0;
+            UINT32 *dst = ctx->framebuffer + y * ctx->pixels_per_scanline + d->x0;
+            for (UINTN x = 0; x < w; x++) {
+                dst[x] = src[x];
+            }
+        }
+    }
+
+    ctx->dirty_count = 0;
+    trace_end();
+}
+
 // Single-pixel write with bounds checking.
 void gfx_put_pixel(GfxContext *ctx, UINTN x, UINTN y, UINT32 color) {
     if (x >= ctx->width || y >= ctx->height) {
         return;
     }
-    ctx->framebuffer[y * ctx->pixels_per_scanline + x] = to_native_color(ctx, color);
+    ctx->pixels[y * ctx->stride + x] = to_native_color(ctx, color);
+    gfx_mark_dirty(ctx, x, y, 1, 1);
 }
 
 // Fill whole screen with one color.
+// The screen itself is painted with Blt(EfiBltVideoFill), which leaves the back
+// buffer and video memory identical, so pending damage can be dropped.
 void gfx_clear(GfxContext *ctx, UINT32 color) {
+    if (ctx->has_backbuffer) {
+        UINT32 native = to_native_color(ctx, color);
+        for (UINTN y = 0; y < ctx->height; y++) {
+            ctx->fill_span(ctx->pixels + y * ctx->stride, ctx->width, native);
+        }
+    }
+
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL fill = to_blt_pixel(color);
+    if (gop_blt(ctx, &fill, EfiBltVideoFill, 0, 0, 0, 0, ctx->width, ctx->height, 0)) {
+        ctx->dirty_count = 0;
+        return;
+    }
+
+    if (ctx->has_backbuffer) {
+        gfx_mark_dirty(ctx, 0, 0, ctx->width, ctx->height);
+        return;
+    }
+
     UINT32 native = to_native_color(ctx, color);
     for (UINTN y = 0; y < ctx->height; y++) {
-        UINTN row = y * ctx->pixels_per_scanline;
-        for (UINTN x = 0; x < ctx->width; x++) {
-            ctx->framebuffer[row + x] = native;
-        }
+        ctx->fill_span(ctx->pixels + y * ctx->stride, ctx->width, native);
     }
 }
 
@@ -123,13 +561,15 @@ void gfx_fill_rect(GfxContext *ctx, UINTN x, UINTN y, UINTN w, UINTN h, UINT32 c
         y_end = ctx->height;
     }
 
+    if (x >= x_end || y >= y_end) {
+        return;
+    }
+
     UINT32 native = to_native_color(ctx, color);
     for (UINTN yy = y; yy < y_end; yy++) {
-        UINTN row = yy * ctx->pixels_per_scanline;
-        for (UINTN xx = x; xx < x_end; xx++) {
-            ctx->framebuffer[row + xx] = native;
-        }
+        ctx->fill_span(ctx->pixels + yy * ctx->stride + x, x_end - x, native);
     }
+    gfx_mark_dirty(ctx, x, y, x_end - x, y_end - y);
 }
 
 // Simple vertical gradient between two RGB colors.
@@ -151,9 +591,85 @@ void gfx_draw_gradient(GfxContext *ctx, UINT32 top_color, UINT32 bottom_color) {
         UINT32 color = ((UINT32)r << 16) | ((UINT32)g << 8) | b;
         UINT32 native = to_native_color(ctx, color);
 
-        UINTN row = y * ctx->pixels_per_scanline;
-        for (UINTN x = 0; x < ctx->width; x++) {
-            ctx->framebuffer[row + x] = native;
+        ctx->fill_span(ctx->pixels + y * ctx->stride, ctx->width, native);
+    }
+    gfx_mark_dirty(ctx, 0, 0, ctx->width, ctx->height);
+}
+
+// Move a screen rectangle (e.g. shell scroll). With a back buffer, pending
+// damage is flushed first so one VideoToVideo Blt can move the visible pixels
+// while the RAM copy is moved in lockstep; nothing is re-sent to the screen.
+void gfx_copy_rect(GfxContext *ctx, UINTN src_x, UINTN src_y, UINTN dst_x, UINTN dst_y, UINTN w, UINTN h) {
+    if (src_x >= ctx->width || src_y >= ctx->height || dst_x >= ctx->width || dst_y >= ctx->height) {
+        return;
+    }
+    UINTN max_x = (src_x > dst_x) ? src_x : dst_x;
+    UINTN max_y = (src_y > dst_y) ? src_y : dst_y;
+    if (w > ctx->width - max_x) {
+        w = ctx->width - max_x;
+    }
+    if (h > ctx->height - max_y) {
+        h = ctx->height - max_y;
+    }
+    if (w == 0 || h == 0) {
+        return;
+    }
+
+    if (ctx->has_backbuffer) {
+        gfx_present(ctx);
+        copy_pixels(ctx->pixels, ctx->stride, src_x, src_y, dst_x, dst_y, w, h);
+        if (!gop_blt(ctx, NULL, EfiBltVideoToVideo, src_x, src_y, dst_x, dst_y, w, h, 0)) {
+            gfx_mark_dirty(ctx, dst_x, dst_y, w, h);
         }
+        return;
+    }
+
+    if (!gop_blt(ctx, NULL, EfiBltVideoToVideo, src_x, src_y, dst_x, dst_y, w, h, 0)) {
+        copy_pixels(ctx->framebuffer, ctx->pixels_per_scanline, src_x, src_y, dst_x, dst_y, w, h);
     }
 }
+
+// Draw a block of 0xRRGGBB pixels (the same memory layout as a Blt pixel).
+// src_stride is in pixels. Without a back buffer this is a BufferToVideo Blt.
+void gfx_blit(GfxContext *ctx, const UINT32 *src, UINTN src_stride, UINTN dst_x, UINTN dst_y, UINTN w, UINTN h) {
+    if (src == NULL || dst_x >= ctx->width || dst_y >= ctx->height) {
+        return;
+    }
+    if (w > ctx->width - dst_x) {
+        w = ctx->width - dst_x;
+    }
+    if (h > ctx->height - dst_y) {
+        h = ctx->height - dst_y;
+    }
+    if (w == 0 || h == 0) {
+        return;
+    }
+
+    if (!ctx->has_backbuffer &&
+        gop_blt(ctx, (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)src, EfiBltBufferToVideo,
+                0, 0, dst_x, dst_y, w, h, src_stride * sizeof(UINT32))) {
+        return;
+    }
+
+    for (UINTN y = 0; y < h; y++) {
+        ctx->format->convert_row(ctx, ctx->pixels + (dst_y + y) * ctx->stride + dst_x, src + y * src_stride, w);
+    }
+    gfx_mark_dirty(ctx, dst_x, dst_y, w, h);
+}
+
+// Convert one BMP row straight into the drawing target (back buffer, or video
+// memory when there is none) without an intermediate 0xRRGGBB copy.
+void gfx_blit_bmp_row(GfxContext *ctx, const UINT8 *src, UINTN bytes_per_pixel, UINTN dst_x, UINTN dst_y, UINTN w) {
+    if (src == NULL || dst_x >= ctx->width || dst_y >= ctx->height) {
+        return;
+    }
+    if (w > ctx->width - dst_x) {
+        w = ctx->width - dst_x;
+    }
+    if (w == 0) {
+        return;
+    }
+
+    ctx->bmp_row(ctx, ctx->pixels + dst_y * ctx->stride + dst_x, src, w, bytes_per_pixel);
+    gfx_mark_dirty(ctx, dst_x, dst_y, w, 1);
+}
@@ -3,7 +3,51 @@
 
 #include <efi.h>
 
+// Max number of separate damaged regions tracked before they get merged.
+#define GFX_DIRTY_MAX 8
+
+typedef struct {
+    UINTN x0;
+    UINTN y0;
+    UINTN x1;
+    UINTN y1;
+} GfxRect;
+
+// Fills `count` pixels starting at dst with an already-native pixel value.
+typedef void (*GfxSpanFillFn)(UINT32 *dst, UINTN count, UINT32 native);
+
+// Placement of one 8-bit color channel inside a PixelBitMask pixel:
+// native bits = ((c >> rshift) << lshift) & mask.
+typedef struct {
+    UINT32 mask;
+    UINT8 rshift;
+    UINT8 lshift;
+} GfxChannel;
+
+// Running render totals, read as before/after deltas by the shell's `perf`.
+typedef struct {
+    UINT64 glyphs;
+    UINT64 glyph_pixels;
+    UINT64 presents;
+    UINT64 present_pixels;
+} GfxCounters;
+
+struct GfxContext;
+
+// Converts `count` packed BMP pixels (B,G,R for 3 bytes per pixel, B,G,R,X
+// for 4) into framebuffer-native pixels.
+typedef void (*GfxBmpRowFn)(const struct GfxContext *ctx, UINT32 *dst, const UINT8 *src, UINTN count, UINTN bytes_per_pixel);
+
+// Per-format pixel packing back end, selected once in gfx_init.
+// Inputs are 0xRRGGBB; outputs are framebuffer-native 32-bit pixels.
 typedef struct {
+    const char *name;
+    UINT32 (*pack)(const struct GfxContext *ctx, UINT32 rgb);
+    void (*convert_row)(const struct GfxContext *ctx, UINT32 *dst, const UINT32 *src, UINTN count);
+    GfxBmpRowFn convert_bmp_row;
+} GfxFormatOps;
+
+typedef struct GfxContext {
     EFI_GRAPHICS_OUTPUT_PROTOCOL *gop;
     UINT32 *framebuffer;
     EFI_PHYSICAL_ADDRESS framebuffer_base;
@@ -12,12 +56,43 @@ typedef struct {
     UINTN height;
     UINTN pixels_per_scanline;
     EFI_GRAPHICS_PIXEL_FORMAT pixel_format;
+    const GfxFormatOps *format;
+    GfxChannel red;
+    GfxChannel green;
+    GfxChannel blue;
+
+    // Drawing target. Points at the RAM back buffer when one could be
+    // allocated, otherwise straight at the GOP framebuffer.
+    UINT32 *pixels;
+    UINTN stride;
+    BOOLEAN has_backbuffer;
+
+    // Span fill kernel chosen once in gfx_init from CPUID and target type.
+    GfxSpanFillFn fill_span;
+    const char *fill_kernel;
+
+    // BMP row converter: byte-shuffle kernel when available, else the
+    // format's scalar convert_bmp_row.
+    GfxBmpRowFn bmp_row;
+    const char *bmp_kernel;
+
+    // Regions of the back buffer that differ from video memory.
+    GfxRect dirty[GFX_DIRTY_MAX];
+    UINTN dirty_count;
+
+    GfxCounters counters;
 } GfxContext;
 
+UINT32 gfx_native_color(const GfxContext *ctx, UINT32 rgb);
 EFI_STATUS gfx_init(EFI_SYSTEM_TABLE *st, GfxContext *ctx, UINTN target_w, UINTN target_h);
 void gfx_clear(GfxContext *ctx, UINT32 color);
 void gfx_draw_gradient(GfxContext *ctx, UINT32 top_color, UINT32 bottom_color);
 void gfx_put_pixel(GfxContext *ctx, UINTN x, UINTN y, UINT32 color);
 void gfx_fill_rect(GfxContext *ctx, UINTN x, UINTN y, UINTN w, UINTN h, UINT32 color);
+void gfx_copy_rect(GfxContext *ctx, UINTN src_x, UINTN src_y, UINTN dst_x, UINTN dst_y, UINTN w, UINTN h);
+void gfx_blit(GfxContext *ctx, const UINT32 *src, UINTN src_stride, UINTN dst_x, UINTN dst_y, UINTN w, UINTN h);
+void gfx_blit_bmp_row(GfxContext *ctx, const UINT8 *src, UINTN bytes_per_pixel, UINTN dst_x, UINTN dst_y, UINTN w);
+void gfx_mark_dirty(GfxContext *ctx, UINTN x, UINTN y, UINTN w, UINTN h);
+void gfx_present(GfxContext *ctx);
 
 #endif
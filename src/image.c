@@ -0,0 +1,583 @@
+#include "image.h"
+#include <efilib.h>
+
+#define BMP_FILE_HEADER_SIZE 14
+#define BMP_HEADER_SIZE 54
+
+#define QOI_HEADER_SIZE 14
+#define QOI_PIXELS_MAX 400000000ULL
+#define QOI_OP_INDEX 0x00
+#define QOI_OP_DIFF 0x40
+#define QOI_OP_LUMA 0x80
+#define QOI_OP_RUN 0xC0
+#define QOI_OP_RGB 0xFE
+#define QOI_OP_RGBA 0xFF
+#define QOI_MASK_2 0xC0
+
+typedef struct {
+    UINT64 pixel_offset;
+    UINTN width;
+    UINTN height;
+    UINTN bytes_per_pixel;
+    UINTN row_stride;
+    BOOLEAN top_down;
+} ImageBmpInfo;
+
+// Largest source box (pixels averaged into one output pixel) the downscaler
+// accepts: 255 * box must fit the 32-bit channel sums.
+#define IMAGE_SCALE_MAX_BOX (1U << 24)
+
+typedef struct {
+    GfxContext *gfx;
+    UINTN bytes_per_pixel;
+    UINTN src_w;
+    UINTN src_h;
+
+    // Placement: 1:1 copies the source window at (src_x, src_y); when scaling
+    // the whole source is box-filtered down to dst_w x dst_h.
+    BOOLEAN scale;
+    UINTN src_x;
+    UINTN src_y;
+    UINTN dst_x;
+    UINTN dst_y;
+    UINTN dst_w;
+    UINTN dst_h;
+
+    // Downscaler state (one allocation at mem).
+    void *mem;
+    UINTN *col_start;     // dst_w + 1 source column boundaries
+    // Per-column 32.32 reciprocals of the box area. A box spans either
+    // box_rows or box_rows + 1 source rows, so one table for each.
+    UINT64 *recip;
+    UINT64 *recip_tall;
+    UINTN box_rows;
+    UINT32 *acc;          // B,G,R sums for the output row in progress
+    UINT32 *out;          // finished output row as 0xRRGGBB
+    UINTN out_row;
+    UINTN rows_in;
+    UINTN next_row_start; // first source row of the next output row
+} ImageSink;
+
+static UINT16 image_read_le16(const UINT8 *p) {
+    return (UINT16)(p[0] | ((UINT16)p[1] << 8));
+}
+
+static UINT32 image_read_le32(const UINT8 *p) {
+    return (UINT32)(p[0] |
+                    ((UINT32)p[1] << 8) |
+                    ((UINT32)p[2] << 16) |
+                    ((UINT32)p[3] << 24));
+}
+
+static UINT32 image_read_be32(const UINT8 *p) {
+    return ((UINT32)p[0] << 24) |
+           ((UINT32)p[1] << 16) |
+           ((UINT32)p[2] << 8) |
+           (UINT32)p[3];
+}
+
+// ImageIo used when the caller passes none: direct firmware calls, with the
+// system table as context.
+static EFI_STATUS image_fw_read(void *ctx, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf) {
+    (void)ctx;
+    return uefi_call_wrapper(file->Read, 3, file, size, buf);
+}
+
+static EFI_STATUS image_fw_set_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 position) {
+    (void)ctx;
+    return uefi_call_wrapper(file->SetPosition, 2, file, position);
+}
+
+static EFI_STATUS image_fw_get_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 *position) {
+    (void)ctx;
+    return uefi_call_wrapper(file->GetPosition, 2, file, position);
+}
+
+static void *image_fw_alloc(void *ctx, UINTN size) {
+    EFI_SYSTEM_TABLE *st = (EFI_SYSTEM_TABLE *)ctx;
+    void *ptr = NULL;
+    EFI_STATUS status = uefi_call_wrapper(st->BootServices->AllocatePool, 3, EfiLoaderData, size, &ptr);
+    return EFI_ERROR(status) ? NULL : ptr;
+}
+
+static void image_fw_free(void *ctx, void *ptr) {
+    EFI_SYSTEM_TABLE *st = (EFI_SYSTEM_TABLE *)ctx;
+    uefi_call_wrapper(st->BootServices->FreePool, 1, ptr);
+}
+
+// Read exactly `size` bytes at `offset`. A short read means a truncated file.
+static EFI_STATUS image_read_at(const ImageIo *io, EFI_FILE_PROTOCOL *file, UINT64 offset, void *buf, UINTN size) {
+    EFI_STATUS status = io->set_position(io->ctx, file, offset);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    UINTN read_size = size;
+    status = io->read(io->ctx, file, &read_size, buf);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    return (read_size == size) ? EFI_SUCCESS : EFI_LOAD_ERROR;
+}
+
+// Seeking to 0xFFFFFFFFFFFFFFFF moves to end-of-file, so the position is the
+// size; this avoids allocating an EFI_FILE_INFO just to read FileSize.
+static EFI_STATUS image_file_size(const ImageIo *io, EFI_FILE_PROTOCOL *file, UINT64 *out_size) {
+    EFI_STATUS status = io->set_position(io->ctx, file, 0xFFFFFFFFFFFFFFFFULL);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    return io->get_position(io->ctx, file, out_size);
+}
+
+// Parse and validate the BMP headers, including that every pixel row the
+// header promises is actually present in the file.
+static EFI_STATUS image_bmp_parse(const ImageIo *io, EFI_FILE_PROTOCOL *file, ImageBmpInfo *out) {
+    UINT8 hdr[BMP_HEADER_SIZE];
+    UINT64 file_size = 0;
+
+    EFI_STATUS status = image_file_size(io, file, &file_size);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    if (file_size < BMP_HEADER_SIZE) {
+        return EFI_UNSUPPORTED;
+    }
+    status = image_read_at(io, file, 0, hdr, sizeof(hdr));
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    if (hdr[0] != 'B' || hdr[1] != 'M') {
+        return EFI_UNSUPPORTED;
+    }
+
+    UINT32 pixel_offset = image_read_le32(hdr + 10);
+    UINT32 dib_size = image_read_le32(hdr + BMP_FILE_HEADER_SIZE);
+    INT32 width = (INT32)image_read_le32(hdr + 18);
+    INT32 height = (INT32)image_read_le32(hdr + 22);
+    UINT16 planes = image_read_le16(hdr + 26);
+    UINT16 bits_per_pixel = image_read_le16(hdr + 28);
+    UINT32 compression = image_read_le32(hdr + 30);
+
+    if (dib_size < 40 || width <= 0 || height == 0 || planes != 1) {
+        return EFI_UNSUPPORTED;
+    }
+    if (compression != 0 || (bits_per_pixel != 24 && bits_per_pixel != 32)) {
+        return EFI_UNSUPPORTED;
+    }
+
+    out->width = (UINTN)width;
+    out->height = (height < 0) ? (UINTN)(-(INT64)height) : (UINTN)height;
+    out->bytes_per_pixel = bits_per_pixel / 8;
+    out->top_down = (height < 0);
+    out->pixel_offset = pixel_offset;
+    if (out->width > (((UINTN)-1) - 3) / out->bytes_per_pixel) {
+        return EFI_UNSUPPORTED;
+    }
+
+    out->row_stride = (out->width * out->bytes_per_pixel + 3) & ~(UINTN)3;
+    if (out->height > ((UINTN)-1) / out->row_stride) {
+        return EFI_UNSUPPORTED;
+    }
+    UINT64 pixel_data_size = (UINT64)out->row_stride * out->height;
+    if (pixel_offset > file_size || pixel_data_size > file_size - pixel_offset) {
+        return EFI_UNSUPPORTED;
+    }
+    return EFI_SUCCESS;
+}
+
+// Fit an oversized image to the screen with one fixed-point box filter pass,
+// or place it 1:1 (centered, cropped if needed). Rows arrive top to bottom as
+// packed B,G,R[,X] bytes from whichever decoder is running.
+static EFI_STATUS image_sink_init(const ImageIo *io, ImageSink *sink, GfxContext *gfx, UINTN src_w, UINTN src_h, UINTN bytes_per_pixel) {
+    sink->gfx = gfx;
+    sink->bytes_per_pixel = bytes_per_pixel;
+    sink->src_w = src_w;
+    sink->src_h = src_h;
+    sink->scale = FALSE;
+    sink->mem = NULL;
+
+    if (src_w > gfx->width || src_h > gfx->height) {
+        UINTN dst_w;
+        UINTN dst_h;
+        if ((UINT64)src_w * gfx->height >= (UINT64)src_h * gfx->width) {
+            dst_w = gfx->width;
+            dst_h = (UINTN)(((UINT64)src_h * gfx->width) / src_w);
+        } else {
+            dst_h = gfx->height;
+            dst_w = (UINTN)(((UINT64)src_w * gfx->height) / src_h);
+        }
+        if (dst_w == 0) {
+            dst_w = 1;
+        }
+        if (dst_h == 0) {
+            dst_h = 1;
+        }
+
+        // Channel sums are 32-bit, so cap the source box area; absurd ratios
+        // fall back to a centered crop.
+        UINT64 box = (UINT64)((src_w + dst_w - 1) / dst_w) * ((src_h + dst_h - 1) / dst_h);
+        if (box <= IMAGE_SCALE_MAX_BOX) {
+            UINTN size = (dst_w + 1) * sizeof(UINTN) + dst_w * 2 * sizeof(UINT64) + dst_w * 4 * sizeof(UINT32);
+            sink->mem = io->alloc(io->ctx, size);
+            if (sink->mem == NULL) {
+                return EFI_OUT_OF_RESOURCES;
+            }
+
+            sink->col_start = (UINTN *)sink->mem;
+            sink->recip = (UINT64 *)(sink->col_start + dst_w + 1);
+            sink->recip_tall = sink->recip + dst_w;
+            sink->acc = (UINT32 *)(sink->recip_tall + dst_w);
+            sink->out = sink->acc + dst_w * 3;
+            for (UINTN x = 0; x <= dst_w; x++) {
+                sink->col_start[x] = (UINTN)(((UINT64)x * src_w) / dst_w);
+            }
+            // Output row k covers source rows [k*src_h/dst_h, (k+1)*src_h/dst_h),
+            // which is floor(src_h/dst_h) or one more rows tall.
+            sink->box_rows = src_h / dst_h;
+            for (UINTN x = 0; x < dst_w; x++) {
+                UINT64 cols = sink->col_start[x + 1] - sink->col_start[x];
+                sink->recip[x] = ((UINT64)1 << 32) / (cols * sink->box_rows);
+                sink->recip_tall[x] = ((UINT64)1 << 32) / (cols * (sink->box_rows + 1));
+            }
+            for (UINTN i = 0; i < dst_w * 3; i++) {
+                sink->acc[i] = 0;
+            }
+
+            sink->scale = TRUE;
+            sink->dst_w = dst_w;
+            sink->dst_h = dst_h;
+            sink->dst_x = (gfx->width - dst_w) / 2;
+            sink->dst_y = (gfx->height - dst_h) / 2;
+            sink->src_x = 0;
+            sink->src_y = 0;
+            sink->out_row = 0;
+            sink->rows_in = 0;
+            sink->next_row_start = (UINTN)((UINT64)src_h / dst_h);
+            return EFI_SUCCESS;
+        }
+    }
+
+    sink->src_x = 0;
+    sink->src_y = 0;
+    sink->dst_w = src_w;
+    sink->dst_h = src_h;
+    sink->dst_x = 0;
+    sink->dst_y = 0;
+    if (src_w > gfx->width) {
+        sink->src_x = (src_w - gfx->width) / 2;
+        sink->dst_w = gfx->width;
+    } else {
+        sink->dst_x = (gfx->width - src_w) / 2;
+    }
+    if (src_h > gfx->height) {
+        sink->src_y = (src_h - gfx->height) / 2;
+        sink->dst_h = gfx->height;
+    } else {
+        sink->dst_y = (gfx->height - src_h) / 2;
+    }
+    return EFI_SUCCESS;
+}
+
+static void image_sink_free(const ImageIo *io, ImageSink *sink) {
+    if (sink->mem != NULL) {
+        io->free(io->ctx, sink->mem);
+        sink->mem = NULL;
+    }
+}
+
+// Source rows the sink actually looks at; decoders that can seek skip the rest.
+static void image_sink_rows(const ImageSink *sink, UINTN *first, UINTN *count) {
+    *first = sink->scale ? 0 : sink->src_y;
+    *count = sink->scale ? sink->src_h : sink->dst_h;
+}
+
+// Average the finished box row. Each column's divisor is replaced by a 32.32
+// reciprocal from the table for this box's height, both built once in
+// image_sink_init, so the emit path has no divisions.
+static void image_sink_emit(ImageSink *sink) {
+    const UINT64 *recips = (sink->rows_in > sink->box_rows) ? sink->recip_tall : sink->recip;
+    UINT32 *acc = sink->acc;
+    for (UINTN x = 0; x < sink->dst_w; x++, acc += 3) {
+        UINT64 recip = recips[x];
+        UINT32 b = (UINT32)(((UINT64)acc[0] * recip + 0x80000000ULL) >> 32);
+        UINT32 g = (UINT32)(((UINT64)acc[1] * recip + 0x80000000ULL) >> 32);
+        UINT32 r = (UINT32)(((UINT64)acc[2] * recip + 0x80000000ULL) >> 32);
+        sink->out[x] = (r << 16) | (g << 8) | b;
+        acc[0] = 0;
+        acc[1] = 0;
+        acc[2] = 0;
+    }
+
+    gfx_blit(sink->gfx, sink->out, sink->dst_w, sink->dst_x, sink->dst_y + sink->out_row, sink->dst_w, 1);
+    sink->out_row++;
+    sink->rows_in = 0;
+    sink->next_row_start = (UINTN)(((UINT64)(sink->out_row + 1) * sink->src_h) / sink->dst_h);
+}
+
+static void image_sink_row(ImageSink *sink, UINTN src_row, const UINT8 *row) {
+    if (!sink->scale) {
+        if (src_row >= sink->src_y && src_row - sink->src_y < sink->dst_h) {
+            gfx_blit_bmp_row(
+                sink->gfx,
+                row + sink->src_x * sink->bytes_per_pixel,
+                sink->bytes_per_pixel,
+                sink->dst_x,
+                sink->dst_y + (src_row - sink->src_y),
+                sink->dst_w
+            );
+        }
+        return;
+    }
+
+    UINTN bpp = sink->bytes_per_pixel;
+    const UINT8 *p = row;
+    UINT32 *acc = sink->acc;
+    for (UINTN x = 0; x < sink->dst_w; x++, acc += 3) {
+        UINT32 b = 0;
+        UINT32 g = 0;
+        UINT32 r = 0;
+        for (UINTN c = sink->col_start[x]; c < sink->col_start[x + 1]; c++, p += bpp) {
+            b += p[0];
+            g += p[1];
+            r += p[2];
+        }
+        acc[0] += b;
+        acc[1] += g;
+        acc[2] += r;
+    }
+
+    sink->rows_in++;
+    if (src_row + 1 >= sink->next_row_start && sink->out_row < sink->dst_h) {
+        image_sink_emit(sink);
+    }
+}
+
+static EFI_STATUS image_draw_bmp(const ImageIo *io, GfxContext *gfx, EFI_FILE_PROTOCOL *file) {
+    ImageBmpInfo bmp;
+    EFI_STATUS status = image_bmp_parse(io, file, &bmp);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+
+    ImageSink sink;
+    status = image_sink_init(io, &sink, gfx, bmp.width, bmp.height, bmp.bytes_per_pixel);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+
+    UINTN first_row;
+    UINTN row_count;
+    image_sink_rows(&sink, &first_row, &row_count);
+
+    UINTN chunk_rows = IMAGE_CHUNK_BYTES / bmp.row_stride;
+    if (chunk_rows == 0) {
+        chunk_rows = 1;
+    }
+    if (chunk_rows > row_count) {
+        chunk_rows = row_count;
+    }
+
+    UINT8 *buf = (UINT8 *)io->alloc(io->ctx, chunk_rows * bmp.row_stride);
+    if (buf == NULL) {
+        image_sink_free(io, &sink);
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    // Decode top to bottom. A chunk of image rows is one contiguous run of file
+    // rows either way; bottom-up files just store that run in reverse order.
+    for (UINTN y = 0; y < row_count; y += chunk_rows) {
+        UINTN n = ((row_count - y) > chunk_rows) ? chunk_rows : (row_count - y);
+        UINTN first = first_row + y;
+        UINTN file_row = bmp.top_down ? first : (bmp.height - (first + n));
+        status = image_read_at(io, file, bmp.pixel_offset + (UINT64)file_row * bmp.row_stride, buf, n * bmp.row_stride);
+        if (EFI_ERROR(status)) {
+            break;
+        }
+
+        for (UINTN i = 0; i < n; i++) {
+            image_sink_row(&sink, first + i, buf + (bmp.top_down ? i : (n - 1 - i)) * bmp.row_stride);
+        }
+    }
+
+    io->free(io->ctx, buf);
+    image_sink_free(io, &sink);
+    return status;
+}
+
+// Sequential byte reader over a file, refilled IMAGE_CHUNK_BYTES at a time.
+// Reading past the end yields zeros and records EFI_LOAD_ERROR.
+typedef struct {
+    const ImageIo *io;
+    EFI_FILE_PROTOCOL *file;
+    UINT8 *buf;
+    UINTN pos;
+    UINTN len;
+    EFI_STATUS status;
+} ImageReader;
+
+static void image_reader_fill(ImageReader *r) {
+    r->pos = 0;
+    r->len = IMAGE_CHUNK_BYTES;
+    EFI_STATUS status = r->io->read(r->io->ctx, r->file, &r->len, r->buf);
+    if (EFI_ERROR(status)) {
+        r->len = 0;
+        r->status = status;
+    } else if (r->len == 0) {
+        r->status = EFI_LOAD_ERROR;
+    }
+}
+
+static inline UINT8 image_reader_byte(ImageReader *r) {
+    if (r->pos == r->len) {
+        if (EFI_ERROR(r->status)) {
+            return 0;
+        }
+        image_reader_fill(r);
+        if (r->len == 0) {
+            return 0;
+        }
+    }
+    return r->buf[r->pos++];
+}
+
+// Decode a QOI image (https://qoiformat.org) row by row into a B,G,R,A row
+// buffer and hand each row to the sink. Alpha is ignored; the image is drawn
+// opaque. Decoding stops once the last row the sink needs is done.
+static EFI_STATUS image_draw_qoi(const ImageIo *io, GfxContext *gfx, EFI_FILE_PROTOCOL *file) {
+    UINT8 hdr[QOI_HEADER_SIZE];
+    EFI_STATUS status = image_read_at(io, file, 0, hdr, sizeof(hdr));
+    if (EFI_ERROR(status)) {
+        return (status == EFI_LOAD_ERROR) ? EFI_UNSUPPORTED : status;
+    }
+
+    UINTN width = image_read_be32(hdr + 4);
+    UINTN height = image_read_be32(hdr + 8);
+    UINT8 channels = hdr[12];
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4)) {
+        return EFI_UNSUPPORTED;
+    }
+    if ((UINT64)width * height > QOI_PIXELS_MAX) {
+        return EFI_UNSUPPORTED;
+    }
+
+    ImageSink sink;
+    status = image_sink_init(io, &sink, gfx, width, height, 4);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    UINTN first_row;
+    UINTN row_count;
+    image_sink_rows(&sink, &first_row, &row_count);
+
+    ImageReader reader = { io, file, NULL, 0, 0, EFI_SUCCESS };
+    UINT8 *row = NULL;
+    reader.buf = (UINT8 *)io->alloc(io->ctx, IMAGE_CHUNK_BYTES + width * 4);
+    if (reader.buf == NULL) {
+        image_sink_free(io, &sink);
+        return EFI_OUT_OF_RESOURCES;
+    }
+    row = reader.buf + IMAGE_CHUNK_BYTES;
+
+    // Index entries are B,G,R,A so a hit copies straight into the row.
+    UINT8 index[64][4];
+    for (UINTN i = 0; i < 64; i++) {
+        index[i][0] = 0;
+        index[i][1] = 0;
+        index[i][2] = 0;
+        index[i][3] = 0;
+    }
+    UINT8 b = 0;
+    UINT8 g = 0;
+    UINT8 r = 0;
+    UINT8 a = 255;
+    UINTN run = 0;
+    UINTN end_row = first_row + row_count;
+
+    // The header read left the file positioned at the first chunk.
+    for (UINTN y = 0; y < end_row; y++) {
+        UINT8 *px = row;
+        for (UINTN x = 0; x < width; x++, px += 4) {
+            if (run > 0) {
+                run--;
+            } else {
+                UINT8 op = image_reader_byte(&reader);
+                if (op == QOI_OP_RGB) {
+                    r = image_reader_byte(&reader);
+                    g = image_reader_byte(&reader);
+                    b = image_reader_byte(&reader);
+                } else if (op == QOI_OP_RGBA) {
+                    r = image_reader_byte(&reader);
+                    g = image_reader_byte(&reader);
+                    b = image_reader_byte(&reader);
+                    a = image_reader_byte(&reader);
+                } else if ((op & QOI_MASK_2) == QOI_OP_INDEX) {
+                    b = index[op][0];
+                    g = index[op][1];
+                    r = index[op][2];
+                    a = index[op][3];
+                } else if ((op & QOI_MASK_2) == QOI_OP_DIFF) {
+                    r = (UINT8)(r + ((op >> 4) & 0x03) - 2);
+                    g = (UINT8)(g + ((op >> 2) & 0x03) - 2);
+                    b = (UINT8)(b + (op & 0x03) - 2);
+                } else if ((op & QOI_MASK_2) == QOI_OP_LUMA) {
+                    UINT8 op2 = image_reader_byte(&reader);
+                    INTN dg = (INTN)(op & 0x3F) - 32;
+                    r = (UINT8)(r + dg - 8 + ((op2 >> 4) & 0x0F));
+                    g = (UINT8)(g + dg);
+                    b = (UINT8)(b + dg - 8 + (op2 & 0x0F));
+                } else {
+                    run = op & 0x3F;
+                }
+
+                UINT8 *slot = index[(r * 3 + g * 5 + b * 7 + a * 11) & 63];
+                slot[0] = b;
+                slot[1] = g;
+                slot[2] = r;
+                slot[3] = a;
+            }
+            px[0] = b;
+            px[1] = g;
+            px[2] = r;
+            px[3] = a;
+        }
+
+        if (EFI_ERROR(reader.status)) {
+            status = reader.status;
+            break;
+        }
+        if (y >= first_row) {
+            image_sink_row(&sink, y, row);
+        }
+    }
+
+    io->free(io->ctx, reader.buf);
+    image_sink_free(io, &sink);
+    return status;
+}
+
+EFI_STATUS image_draw_file(EFI_SYSTEM_TABLE *st, GfxContext *gfx, EFI_FILE_PROTOCOL *file, const ImageIo *io) {
+    if (st == NULL || st->BootServices == NULL || gfx == NULL || file == NULL) {
+        return EFI_INVALID_PARAMETER;
+    }
+    ImageIo fw_io = { st, image_fw_read, image_fw_set_position, image_fw_get_position, image_fw_alloc, image_fw_free };
+    if (io == NULL) {
+        io = &fw_io;
+    }
+
+    UINT8 magic[4];
+    EFI_STATUS status = image_read_at(io, file, 0, magic, sizeof(magic));
+    if (status == EFI_LOAD_ERROR) {
+        return EFI_UNSUPPORTED;
+    }
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+
+    if (magic[0] == 'q' && magic[1] == 'o' && magic[2] == 'i' && magic[3] == 'f') {
+        return image_draw_qoi(io, gfx, file);
+    }
+    if (magic[0] == 'B' && magic[1] == 'M') {
+        return image_draw_bmp(io, gfx, file);
+    }
+    return EFI_UNSUPPORTED;
+}
@@ -0,0 +1,29 @@
+#ifndef HATTEROS_IMAGE_H
+#define HATTEROS_IMAGE_H
+
+#include <efi.h>
+#include "gfx.h"
+
+// Upper bound for the pixel buffer used while streaming an image from disk.
+// Rows are read in chunks of at most this many bytes (at least one row).
+#define IMAGE_CHUNK_BYTES (64U * 1024U)
+
+// File and memory access used while decoding, so a caller can count, trace
+// or arena-allocate it. `ctx` is passed back to every callback.
+typedef struct {
+    void *ctx;
+    EFI_STATUS (*read)(void *ctx, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf);
+    EFI_STATUS (*set_position)(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 position);
+    EFI_STATUS (*get_position)(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 *position);
+    void *(*alloc)(void *ctx, UINTN size);
+    void (*free)(void *ctx, void *ptr);
+} ImageIo;
+
+// Stream an image from an open file and draw it centered. Accepts
+// uncompressed 24/32-bit BMP and QOI, picked by the file's magic bytes.
+// Images larger than the screen are box-filtered down to fit (aspect ratio
+// kept). `io` may be NULL for plain firmware calls and pool memory. Returns
+// EFI_UNSUPPORTED when the file is not a format we can decode.
+EFI_STATUS image_draw_file(EFI_SYSTEM_TABLE *st, GfxContext *gfx, EFI_FILE_PROTOCOL *file, const ImageIo *io);
+
+#endif
@@ -4,17 +4,37 @@
 #include "gfx.h"
 #include "font.h"
 #include "shell.h"
-
-static UINT16 read_le16(const UINT8 *p) {
-    return (UINT16)(p[0] | ((UINT16)p[1] << 8));
-}
-
-static UINT32 read_le32(const UINT8 *p) {
-    return (UINT32)(p[0] |
-                    ((UINT32)p[1] << 8) |
-                    ((UINT32)p[2] << 16) |
-                    ((UINT32)p[3] << 24));
-}
+#include "image.h"
+#include "boot.h"
+#include "util.h"
+#include "console.h"
+#include "evlog.h"
+#include "trace.h"
+
+#define SPLASH_GRADIENT_TOP 0x0E1B2C
+#define SPLASH_GRADIENT_BOTTOM 0x253C59
+
+// Composed splash frame (gradient + decoded image) in native pixel format,
+// written after the first successful decode and reused while the key matches.
+#define SPLASH_CACHE_PATH L"\\HATTEROS\\system\\assets\\splash.raw"
+#define SPLASH_CACHE_MAGIC 0x48534331U
+#define SPLASH_CACHE_VERSION 1U
+#define SPLASH_KEY_BYTES 4096
+
+typedef struct {
+    UINT32 magic;
+    UINT32 version;
+    UINT32 mode;
+    UINT32 width;
+    UINT32 height;
+    UINT32 pixel_format;
+    UINT32 red_mask;
+    UINT32 green_mask;
+    UINT32 blue_mask;
+    UINT32 reserved;
+    UINT64 source_key;
+    UINT64 pixel_bytes;
+} SplashCacheHeader;
 
 // Small fallback path for text output when graphics setup fails.
 static void uefi_text(EFI_SYSTEM_TABLE *st, CHAR16 *msg) {
@@ -60,181 +80,169 @@ static EFI_STATUS open_esp_root(EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, E
     return uefi_call_wrapper(fs->OpenVolume, 2, fs, root);
 }
 
-// Load a file from the ESP into boot-service pool memory.
-static EFI_STATUS read_file_from_esp(
-    EFI_HANDLE image_handle,
-    EFI_SYSTEM_TABLE *st,
-    const CHAR16 *path,
-    UINT8 **out_data,
-    UINTN *out_size
-) {
-    if (path == NULL || out_data == NULL || out_size == NULL || st == NULL || st->BootServices == NULL) {
-        return EFI_INVALID_PARAMETER;
-    }
-
-    *out_data = NULL;
-    *out_size = 0;
-
-    EFI_FILE_PROTOCOL *root = NULL;
-    EFI_FILE_PROTOCOL *file = NULL;
-    EFI_FILE_INFO *info = NULL;
-    UINT8 *data = NULL;
-    EFI_STATUS status = open_esp_root(image_handle, st, &root);
-    if (EFI_ERROR(status) || root == NULL) {
-        goto out;
-    }
-
-    status = uefi_call_wrapper(root->Open, 5, root, &file, (CHAR16 *)path, EFI_FILE_MODE_READ, 0);
-    if (EFI_ERROR(status) || file == NULL) {
-        goto out;
+static UINT64 fnv1a64(UINT64 hash, const void *data, UINTN len) {
+    const UINT8 *p = (const UINT8 *)data;
+    for (UINTN i = 0; i < len; i++) {
+        hash ^= p[i];
+        hash *= 0x100000001B3ULL;
     }
+    return hash;
+}
 
+// Cheap fingerprint of a splash source: size, modification time and the first
+// few KiB (which hold the image header). Hashing the whole file would mean
+// reading it on every boot, which is exactly what the cache avoids.
+static EFI_STATUS splash_source_key(EFI_FILE_PROTOCOL *file, UINT64 *out_key) {
+    UINT64 info_buf[(SIZE_OF_EFI_FILE_INFO + 512) / sizeof(UINT64) + 1];
+    UINT8 head[SPLASH_KEY_BYTES];
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
-    UINTN info_size = 0;
-    status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, NULL);
-    if (status != EFI_BUFFER_TOO_SMALL || info_size < SIZE_OF_EFI_FILE_INFO) {
-        status = EFI_LOAD_ERROR;
-        goto out;
-    }
-
-    status = uefi_call_wrapper(st->BootServices->AllocatePool, 3, EfiLoaderData, info_size, (void **)&info);
-    if (EFI_ERROR(status) || info == NULL) {
-        status = EFI_OUT_OF_RESOURCES;
-        goto out;
-    }
+    EFI_FILE_INFO *info = (EFI_FILE_INFO *)info_buf;
+    UINTN info_size = sizeof(info_buf);
 
-    status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, info);
+    EFI_STATUS status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, info);
     if (EFI_ERROR(status)) {
-        goto out;
-    }
-    if ((info->Attribute & EFI_FILE_DIRECTORY) != 0) {
-        status = EFI_INVALID_PARAMETER;
-        goto out;
+        return status;
     }
 
-    if (info->FileSize == 0 || info->FileSize > 32U * 1024U * 1024U) {
-        status = EFI_BAD_BUFFER_SIZE;
-        goto out;
+    UINTN head_size = sizeof(head);
+    status = uefi_call_wrapper(file->SetPosition, 2, file, 0);
+    if (!EFI_ERROR(status)) {
+        status = uefi_call_wrapper(file->Read, 3, file, &head_size, head);
     }
-
-    UINTN file_size = (UINTN)info->FileSize;
-    status = uefi_call_wrapper(st->BootServices->AllocatePool, 3, EfiLoaderData, file_size, (void **)&data);
-    if (EFI_ERROR(status) || data == NULL) {
-        status = EFI_OUT_OF_RESOURCES;
-        goto out;
-    }
-
-    UINTN read_size = file_size;
-    status = uefi_call_wrapper(file->Read, 3, file, &read_size, data);
-    if (EFI_ERROR(status) || read_size != file_size) {
-        status = EFI_LOAD_ERROR;
-        goto out;
+    if (EFI_ERROR(status)) {
+        return status;
     }
 
-    *out_data = data;
-    *out_size = file_size;
-    data = NULL;
-    status = EFI_SUCCESS;
+    UINT64 key = 0xCBF29CE484222325ULL;
+    key = fnv1a64(key, &info->FileSize, sizeof(info->FileSize));
+    key = fnv1a64(key, &info->ModificationTime, sizeof(info->ModificationTime));
+    key = fnv1a64(key, head, head_size);
+    *out_key = key;
+    return EFI_SUCCESS;
+}
 
-out:
-    if (data != NULL) {
-        uefi_call_wrapper(st->BootServices->FreePool, 1, data);
-    }
-    if (info != NULL) {
-        uefi_call_wrapper(st->BootServices->FreePool, 1, info);
-    }
-    if (file != NULL) {
-        uefi_call_wrapper(file->Close, 1, file);
-    }
-    if (root != NULL) {
-        uefi_call_wrapper(root->Close, 1, root);
-    }
-    return status;
+static void splash_cache_header(const GfxContext *gfx, UINT64 source_key, SplashCacheHeader *hdr) {
+    hdr->magic = SPLASH_CACHE_MAGIC;
+    hdr->version = SPLASH_CACHE_VERSION;
+    hdr->mode = gfx->gop->Mode->Mode;
+    hdr->width = (UINT32)gfx->width;
+    hdr->height = (UINT32)gfx->height;
+    hdr->pixel_format = (UINT32)gfx->pixel_format;
+    hdr->red_mask = gfx->red.mask;
+    hdr->green_mask = gfx->green.mask;
+    hdr->blue_mask = gfx->blue.mask;
+    hdr->reserved = 0;
+    hdr->source_key = source_key;
+    hdr->pixel_bytes = (UINT64)gfx->width * gfx->height * sizeof(UINT32);
 }
 
-// Draw a basic uncompressed 24/32-bit BMP centered in the current framebuffer.
-static BOOLEAN draw_bmp_centered(GfxContext *gfx, const UINT8 *bmp, UINTN bmp_size) {
-    if (gfx == NULL || bmp == NULL || bmp_size < 54) {
-        return FALSE;
-    }
-    if (bmp[0] != 'B' || bmp[1] != 'M') {
+// Cache hit: one Read straight into the back buffer; gfx_present then sends it
+// to the screen with one Blt. Needs the back buffer (stride == width).
+static BOOLEAN splash_cache_load(EFI_FILE_PROTOCOL *root, GfxContext *gfx, UINT64 source_key) {
+    if (!gfx->has_backbuffer) {
         return FALSE;
     }
 
-    UINT32 pixel_offset = read_le32(bmp + 10);
-    UINT32 dib_size = read_le32(bmp + 14);
-    INT32 width = (INT32)read_le32(bmp + 18);
-    INT32 height = (INT32)read_le32(bmp + 22);
-    UINT16 planes = read_le16(bmp + 26);
-    UINT16 bits_per_pixel = read_le16(bmp + 28);
-    UINT32 compression = read_le32(bmp + 30);
-
-    if (dib_size < 40 || width <= 0 || height == 0 || planes != 1) {
-        return FALSE;
-    }
-    if (compression != 0 || (bits_per_pixel != 24 && bits_per_pixel != 32)) {
+    EFI_FILE_PROTOCOL *file = NULL;
+    EFI_STATUS status = uefi_call_wrapper(root->Open, 5, root, &file, (CHAR16 *)SPLASH_CACHE_PATH, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(status) || file == NULL) {
         return FALSE;
     }
 
-    UINTN img_w = (UINTN)width;
-    UINTN img_h = (height < 0) ? (UINTN)(-height) : (UINTN)height;
-    UINTN bytes_per_pixel = bits_per_pixel / 8;
-    if (img_w > (((UINTN)-1) - 3) / bytes_per_pixel) {
-        return FALSE;
+    SplashCacheHeader want;
+    SplashCacheHeader have;
+    splash_cache_header(gfx, source_key, &want);
+    UINTN read_size = sizeof(have);
+    status = uefi_call_wrapper(file->Read, 3, file, &read_size, &have);
+    BOOLEAN match = !EFI_ERROR(status) && read_size == sizeof(have);
+    const UINT8 *a = (const UINT8 *)&want;
+    const UINT8 *b = (const UINT8 *)&have;
+    for (UINTN i = 0; match && i < sizeof(want); i++) {
+        match = (a[i] == b[i]);
+    }
+
+    BOOLEAN loaded = FALSE;
+    if (match) {
+        read_size = (UINTN)want.pixel_bytes;
+        status = uefi_call_wrapper(file->Read, 3, file, &read_size, gfx->pixels);
+        loaded = !EFI_ERROR(status) && read_size == (UINTN)want.pixel_bytes;
+        if (!loaded) {
+            // A short read left part of a frame behind; put the base back.
+            gfx_draw_gradient(gfx, SPLASH_GRADIENT_TOP, SPLASH_GRADIENT_BOTTOM);
+        }
     }
+    uefi_call_wrapper(file->Close, 1, file);
 
-    UINTN row_stride = (img_w * bytes_per_pixel + 3) & ~(UINTN)3;
-    if (img_h > ((UINTN)-1) / row_stride) {
-        return FALSE;
+    if (loaded) {
+        gfx_mark_dirty(gfx, 0, 0, gfx->width, gfx->height);
     }
+    return loaded;
+}
 
-    UINTN pixel_data_size = row_stride * img_h;
-    if (pixel_offset > bmp_size || pixel_data_size > bmp_size - pixel_offset) {
-        return FALSE;
-    }
+// Save the composed frame. The header is written last, so a failed or
+// interrupted write leaves a file that never matches.
+static void splash_cache_store(EFI_FILE_PROTOCOL *root, GfxContext *gfx, UINT64 source_key) {
+    static const CHAR16 *const dirs[] = {
+        L"\\HATTEROS",
+        L"\\HATTEROS\\system",
+        L"\\HATTEROS\\system\\assets",
+    };
 
-    UINTN src_x = 0;
-    UINTN src_y = 0;
-    UINTN draw_w = img_w;
-    UINTN draw_h = img_h;
-    UINTN dst_x = 0;
-    UINTN dst_y = 0;
-
-    if (draw_w > gfx->width) {
-        src_x = (draw_w - gfx->width) / 2;
-        draw_w = gfx->width;
-    } else {
-        dst_x = (gfx->width - draw_w) / 2;
+    if (!gfx->has_backbuffer) {
+        return;
     }
 
-    if (draw_h > gfx->height) {
-        src_y = (draw_h - gfx->height) / 2;
-        draw_h = gfx->height;
-    } else {
-        dst_y = (gfx->height - draw_h) / 2;
+    for (UINTN i = 0; i < (sizeof(dirs) / sizeof(dirs[0])); i++) {
+        EFI_FILE_PROTOCOL *dir = NULL;
+        EFI_STATUS status = uefi_call_wrapper(
+            root->Open,
+            5,
+            root,
+            &dir,
+            (CHAR16 *)dirs[i],
+            EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+            EFI_FILE_DIRECTORY
+        );
+        if (EFI_ERROR(status) || dir == NULL) {
+            return;
+        }
+        uefi_call_wrapper(dir->Close, 1, dir);
     }
 
-    const UINT8 *pixel_base = bmp + pixel_offset;
-    BOOLEAN top_down = (height < 0);
-    for (UINTN y = 0; y < draw_h; y++) {
-        UINTN src_row = src_y + y;
-        UINTN bmp_row = top_down ? src_row : (img_h - 1 - src_row);
-        const UINT8 *row = pixel_base + bmp_row * row_stride;
-        const UINT8 *src = row + src_x * bytes_per_pixel;
-
-        for (UINTN x = 0; x < draw_w; x++) {
-            UINT8 b = src[x * bytes_per_pixel + 0];
-            UINT8 g = src[x * bytes_per_pixel + 1];
-            UINT8 r = src[x * bytes_per_pixel + 2];
-            UINT32 rgb = ((UINT32)r << 16) | ((UINT32)g << 8) | b;
-            gfx_put_pixel(gfx, dst_x + x, dst_y + y, rgb);
-        }
+    EFI_FILE_PROTOCOL *file = NULL;
+    EFI_STATUS status = uefi_call_wrapper(
+        root->Open,
+        5,
+        root,
+        &file,
+        (CHAR16 *)SPLASH_CACHE_PATH,
+        EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+        0
+    );
+    if (EFI_ERROR(status) || file == NULL) {
+        return;
     }
 
-    return TRUE;
+    SplashCacheHeader hdr;
+    splash_cache_header(gfx, source_key, &hdr);
+    SplashCacheHeader pending = hdr;
+    pending.magic = 0;
+
+    UINTN write_size = sizeof(pending);
+    status = uefi_call_wrapper(file->Write, 3, file, &write_size, &pending);
+    if (!EFI_ERROR(status)) {
+        write_size = (UINTN)hdr.pixel_bytes;
+        status = uefi_call_wrapper(file->Write, 3, file, &write_size, gfx->pixels);
+    }
+    if (!EFI_ERROR(status) && write_size == (UINTN)hdr.pixel_bytes) {
+        uefi_call_wrapper(file->SetPosition, 2, file, 0);
+        write_size = sizeof(hdr);
+        uefi_call_wrapper(file->Write, 3, file, &write_size, &hdr);
+    }
+    uefi_call_wrapper(file->Close, 1, file);
 }
 
-// Try to draw a BMP splash from ESP. Returns FALSE if file is missing or invalid.
+// Try to draw an image splash from ESP. Returns FALSE if file is missing or invalid.
 // If diagnostic_out is set, it receives a short fallback reason for on-screen debug text.
 static BOOLEAN draw_external_splash(
     EFI_HANDLE image_handle,
@@ -251,35 +259,64 @@ static BOOLEAN draw_external_splash(
 
     // Accept common locations/case variants so users can drop assets in esp_files/
     // without having to match one exact path.
+    // QOI comes first: it is several times smaller, so boot reads less.
     static const CHAR16 *const candidates[] = {
+        L"\\EFI\\BOOT\\SPLASH.QOI",
+        L"\\EFI\\BOOT\\splash.qoi",
+        L"\\SPLASH.QOI",
+        L"\\splash.qoi",
         L"\\EFI\\BOOT\\SPLASH.BMP",
         L"\\EFI\\BOOT\\splash.bmp",
         L"\\SPLASH.BMP",
         L"\\splash.bmp",
     };
 
-    for (UINTN i = 0; i < (sizeof(candidates) / sizeof(candidates[0])); i++) {
-        UINT8 *bmp_data = NULL;
-        UINTN bmp_size = 0;
-        EFI_STATUS status = read_file_from_esp(image_handle, st, candidates[i], &bmp_data, &bmp_size);
-        if (EFI_ERROR(status) || bmp_data == NULL) {
+    EFI_FILE_PROTOCOL *root = NULL;
+    EFI_STATUS status = open_esp_root(image_handle, st, &root);
+    if (EFI_ERROR(status) || root == NULL) {
+        if (status != EFI_NOT_FOUND && diagnostic_out != NULL) {
+            *diagnostic_out = "splash read error (using built-in splash)";
+        }
+        return FALSE;
+    }
+
+    BOOLEAN drawn = FALSE;
+    for (UINTN i = 0; i < (sizeof(candidates) / sizeof(candidates[0])) && !drawn; i++) {
+        EFI_FILE_PROTOCOL *file = NULL;
+        status = uefi_call_wrapper(root->Open, 5, root, &file, (CHAR16 *)candidates[i], EFI_FILE_MODE_READ, 0);
+        if (EFI_ERROR(status) || file == NULL) {
             if (status != EFI_NOT_FOUND && diagnostic_out != NULL) {
                 *diagnostic_out = "splash read error (using built-in splash)";
             }
             continue;
         }
 
-        BOOLEAN ok = draw_bmp_centered(gfx, bmp_data, bmp_size);
-        uefi_call_wrapper(st->BootServices->FreePool, 1, bmp_data);
-        if (ok) {
-            return TRUE;
+        UINT64 key = 0;
+        BOOLEAN have_key = !EFI_ERROR(splash_source_key(file, &key));
+        if (have_key && splash_cache_load(root, gfx, key)) {
+            uefi_call_wrapper(file->Close, 1, file);
+            drawn = TRUE;
+            break;
         }
-        if (diagnostic_out != NULL) {
-            *diagnostic_out = "splash format unsupported (need 24/32-bit BMP)";
+
+        // Rows stream straight from the file into the back buffer; the
+        // image is never held in memory as a whole.
+        status = image_draw_file(st, gfx, file, NULL);
+        uefi_call_wrapper(file->Close, 1, file);
+        if (!EFI_ERROR(status)) {
+            drawn = TRUE;
+            if (have_key) {
+                splash_cache_store(root, gfx, key);
+            }
+        } else if (diagnostic_out != NULL) {
+            *diagnostic_out = (status == EFI_UNSUPPORTED)
+                ? "splash format unsupported (need QOI or 24/32-bit BMP)"
+                : "splash read error (using built-in splash)";
         }
     }
 
-    return FALSE;
+    uefi_call_wrapper(root->Close, 1, root);
+    return drawn;
 }
 
 // Draw a procedural top-hat icon so we do not need external image assets.
@@ -306,10 +343,11 @@ static void draw_hat_icon(GfxContext *gfx, UINTN center_x, UINTN center_y, UINTN
     gfx_fill_rect(gfx, crown_x + 8 * scale, crown_y + 10 * scale, 8 * scale, crown_h - 20 * scale, highlight);
 }
 
-// Paint the splash scene. If /EFI/BOOT/SPLASH.BMP exists and parses, use it.
+// Paint the splash scene. If /EFI/BOOT/SPLASH.QOI or SPLASH.BMP exists and
+// parses (or its cached frame matches), use it.
 // Otherwise, fall back to the built-in procedural HatterOS splash.
 static void draw_splash(EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContext *gfx) {
-    gfx_draw_gradient(gfx, 0x0E1B2C, 0x253C59);
+    gfx_draw_gradient(gfx, SPLASH_GRADIENT_TOP, SPLASH_GRADIENT_BOTTOM);
     const char *splash_diag = NULL;
 
     if (!draw_external_splash(image_handle, st, gfx, &splash_diag)) {
@@ -327,19 +365,21 @@ static void draw_splash(EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContex
         font_draw_text(gfx, 12, 10, splash_diag, 0xFFD79A, 0, 1, TRUE);
     }
 
-    const char *hint = "Press any key to continue...";
+    const char *hint = "Press any key to continue. H: headless";
     UINTN hint_scale = 2;
     UINTN hint_w = font_text_width(hint, hint_scale);
     UINTN hint_x = (gfx->width > hint_w) ? (gfx->width - hint_w) / 2 : 8;
     UINTN hint_y = gfx->height - 80;
 
     font_draw_text(gfx, hint_x, hint_y, hint, 0xDCE5F2, 0, hint_scale, TRUE);
+    gfx_present(gfx);
 }
 
 // Wait for either keyboard input or a timeout so splash can auto-advance.
-static void wait_for_key_or_timeout(EFI_SYSTEM_TABLE *st, UINTN timeout_ms) {
+// Returns the key pressed, or 0 on timeout.
+static CHAR16 wait_for_key_or_timeout(EFI_SYSTEM_TABLE *st, UINTN timeout_ms) {
     if (st == NULL || st->BootServices == NULL || st->ConIn == NULL) {
-        return;
+        return 0;
     }
 
     EFI_EVENT timer_event;
@@ -353,7 +393,7 @@ static void wait_for_key_or_timeout(EFI_SYSTEM_TABLE *st, UINTN timeout_ms) {
         &timer_event
     );
     if (EFI_ERROR(status)) {
-        return;
+        return 0;
     }
 
     UINT64 ticks_100ns = (UINT64)timeout_ms * 10000ULL;
@@ -363,37 +403,52 @@ static void wait_for_key_or_timeout(EFI_SYSTEM_TABLE *st, UINTN timeout_ms) {
     UINTN index = 0;
     uefi_call_wrapper(st->BootServices->WaitForEvent, 3, 2, events, &index);
 
+    EFI_INPUT_KEY key = {0, 0};
     if (index == 0) {
-        EFI_INPUT_KEY key;
         uefi_call_wrapper(st->ConIn->ReadKeyStroke, 2, st->ConIn, &key);
     }
 
     uefi_call_wrapper(st->BootServices->CloseEvent, 1, timer_event);
+    return key.UnicodeChar;
 }
 
 // UEFI entrypoint: initialize graphics, show splash, then enter the shell.
 EFI_STATUS efi_main(EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *system_table) {
+    boot_mark(BOOT_PHASE_ENTRY);
     if (system_table == NULL || system_table->BootServices == NULL) {
         return EFI_SUCCESS;
     }
 
+    serial_init(system_table);
+    trace_init(system_table->BootServices);
+    serial_writeln("HatterOS " HATTEROS_VERSION " (" HATTEROS_BUILD_DATE ")");
+
     if (system_table->ConIn != NULL && system_table->ConIn->Reset != NULL) {
         uefi_call_wrapper(system_table->ConIn->Reset, 2, system_table->ConIn, FALSE);
     }
+    boot_mark(BOOT_PHASE_CONIN_RESET);
 
     GfxContext gfx;
     EFI_STATUS status = gfx_init(system_table, &gfx, 1024, 768);
     if (EFI_ERROR(status)) {
         // Keep failure mode user-friendly instead of returning cryptic firmware errors.
         uefi_text(system_table, L"HatterOS: GOP init failed, cannot start framebuffer shell.\r\n");
+        evlog_write(EVLOG_SYS_BOOT, EVLOG_LEVEL_ERROR, EVLOG_BOOT_GOP_FAILED, (UINT64)status, 0);
+        serial_writeln("HatterOS: GOP init failed");
+        serial_flush();
         return EFI_SUCCESS;
     }
+    boot_mark(BOOT_PHASE_GFX_INIT);
 
     draw_splash(image_handle, system_table, &gfx);
-    wait_for_key_or_timeout(system_table, 2000);
+    boot_mark(BOOT_PHASE_SPLASH);
+    CHAR16 key = wait_for_key_or_timeout(system_table, 2000);
+    boot_mark(BOOT_PHASE_SPLASH_WAIT);
 
+    // shell_init marks the shell-init and settings phases; shell_run marks
+    // the first prompt and appends this boot to the boot log.
     Shell shell;
-    shell_init(&shell, image_handle, system_table, &gfx);
+    shell_init(&shell, image_handle, system_table, &gfx, console_sinks_for_key(key));
     shell_run(&shell);
 
     return EFI_SUCCESS;
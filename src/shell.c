@@ -1,11 +1,42 @@
 #include "shell.h"
 #include "font.h"
 #include "util.h"
+#include "image.h"
+#include "boot.h"
+#include "cpu.h"
+#include "evlog.h"
+#include "trace.h"
 #include <efilib.h>
 
 #define FILE_IO_CHUNK 8192
 #define SHELL_CFG_PATH "\\HATTEROS\\system\\config\\shell.cfg"
+#define SHELL_CONSOLE_CFG_PATH "\\HATTEROS\\system\\config\\console.cfg"
+#define SHELL_CONSOLE_LOG_PATH "\\HATTEROS\\system\\log\\console.log"
 #define HEXDUMP_COLS 16
+#define SHELL_LOG_DIR "\\HATTEROS\\system\\log"
+// Firmware EFI_FILE_PROTOCOL call that is counted for `perf`, traced as a
+// span, and recorded in the event log under the method name if it fails.
+// shell_file_result ends the span.
+#define SHELL_FILE_CALL(shell, fn, ...) \
+    (trace_begin(TRACE_CAT_FILE, #fn), shell_file_result((shell), #fn, uefi_call_wrapper(fn, __VA_ARGS__)))
+#define SHELL_EVENT_LOG_PATH "\\HATTEROS\\system\\log\\events.bin"
+#define SHELL_ARENA_SLAB_BYTES (SHELL_ARENA_SLAB_PAGES * EFI_PAGE_SIZE)
+#define SHELL_ARENA_LARGE (64U * 1024U)
+#define SHELL_ARENA_ALIGN 16
+// Pending records that trigger a flush at the prompt even without an error.
+#define SHELL_EVENT_FLUSH_BATCH 256
+#define SHELL_BOOT_LOG_PATH "\\HATTEROS\\system\\log\\boot.csv"
+#define SHELL_BENCH_LOG_PATH "\\HATTEROS\\system\\log\\bench.csv"
+#define SHELL_BENCH_TMP_DIR "\\HATTEROS\\system\\tmp"
+#define SHELL_BENCH_TMP_PATH "\\HATTEROS\\system\\tmp\\bench.tmp"
+#define SHELL_BENCH_FILE_BYTES (4U * 1024U * 1024U)
+#define SHELL_BENCH_GFX_ROUNDS 16
+#define SHELL_BENCH_ALLOC_ROUNDS 1024
+#define SHELL_BENCH_RESULTS_MAX 16
+#define SHELL_ARGV_MAX 64
+#define SHELL_PIPE_MAX (64U * 1024U)
+#define SHELL_REDIRECT_BUF (64U * 1024U)
+#define SHELL_ARGS_ANY 0xFF
 #define SHELL_CFG_MAGIC 0x53434647U
 #define SHELL_CFG_VERSION 1U
 
@@ -18,47 +49,92 @@ typedef struct {
     UINT8 reserved[3];
 } ShellConfigFile;
 
+// Command handler. argv[0] is the command name; argc is at least 1.
+typedef void (*ShellCommandFn)(Shell *shell, UINTN argc, char **argv);
+
+// One registered shell command and its argument-count spec.
+typedef struct {
+    const char *name;
+    ShellCommandFn fn;
+    UINT8 min_args;
+    UINT8 max_args;
+    const char *usage;
+    const char *summary;
+    const char *detail;
+} ShellCommand;
+
+// One row of the `bench` table; `name` includes the chunk size for FAT rows.
+typedef struct {
+    char name[24];
+    UINT64 value;
+    const char *unit;
+} ShellBenchResult;
+
 static void shell_newline(Shell *shell);
 static void shell_putc(Shell *shell, char c);
 static void shell_set_cursor(Shell *shell, UINTN row, UINTN col);
-static UINT16 shell_read_le16(const UINT8 *p);
-static UINT32 shell_read_le32(const UINT8 *p);
 static void shell_prompt(Shell *shell);
 static UINTN shell_build_prompt(Shell *shell, char *out, UINTN out_len);
 static void shell_execute(Shell *shell, char *line);
+static UINTN shell_tokenize(const char *line, char *words, UINTN words_len, char **argv, UINTN max_args);
+static void shell_run_pipeline(Shell *shell, UINTN argc, char **argv);
+static BOOLEAN shell_is_operator(const char *word);
+static EFI_STATUS shell_redirect_open(Shell *shell, const char *path, BOOLEAN append, ShellStream *stream);
+static void shell_stream_write(Shell *shell, ShellStream *stream, const char *data, UINTN n);
+static void shell_stream_flush(Shell *shell, ShellStream *stream);
+static EFI_STATUS shell_input_read(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf);
+static void shell_dispatch(Shell *shell, UINTN argc, char **argv);
 static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len);
 static void shell_scroll(Shell *shell);
+static void shell_model_init(Shell *shell);
+static void shell_model_advance(Shell *shell);
+static void shell_model_write(Shell *shell, UINTN row, UINTN col, const char *text, UINTN n);
+static void shell_repaint(Shell *shell);
+static void shell_sync_screen(Shell *shell);
+static BOOLEAN shell_live_view(Shell *shell);
+static void shell_emit(Shell *shell, const char *text, UINTN n);
 static void shell_draw_cursor(Shell *shell, UINTN row, UINTN col);
+static void shell_page_scrollback(Shell *shell, BOOLEAN up);
 static EFI_STATUS shell_open_root(Shell *shell, EFI_FILE_PROTOCOL **root);
+static void shell_dir_cache_flush(Shell *shell);
+static EFI_STATUS shell_dir_cache_get(Shell *shell, const char *dir_path, EFI_FILE_PROTOCOL **out);
 static EFI_STATUS shell_open_path(Shell *shell, const char *path, UINT64 mode, UINT64 attrs, EFI_FILE_PROTOCOL **out);
 static EFI_FILE_INFO *shell_get_file_info(Shell *shell, EFI_FILE_PROTOCOL *file, EFI_STATUS *out_status);
 static EFI_STATUS shell_ensure_dir(Shell *shell, const char *path);
 static EFI_STATUS shell_ensure_dir_tree(Shell *shell, const char *path);
-static BOOLEAN shell_parse_ls_args(const char *arg, BOOLEAN *long_mode, char *path_out, UINTN path_out_len);
 static void shell_print_history(Shell *shell);
 static void shell_print_help(Shell *shell, const char *topic);
+static const ShellCommand *shell_find_command(const char *name);
 static BOOLEAN shell_normalize_path(const char *cwd, const char *input, char *out, UINTN out_len);
 static BOOLEAN shell_path_to_char16(const char *path, CHAR16 *out, UINTN out_len);
 static void shell_print_file_name(Shell *shell, const CHAR16 *name);
 static const char *shell_status_str(EFI_STATUS status);
 static void shell_print_error_status(Shell *shell, const char *prefix, EFI_STATUS status);
-static void shell_cmd_ls(Shell *shell, const char *arg);
-static void shell_cmd_cat(Shell *shell, const char *arg);
-static void shell_cmd_cd(Shell *shell, const char *arg);
-static void shell_cmd_pwd(Shell *shell);
-static void shell_cmd_mkdir(Shell *shell, const char *arg);
-static void shell_cmd_touch(Shell *shell, const char *arg);
-static void shell_cmd_cp(Shell *shell, const char *src_arg, const char *dst_arg);
+static void shell_cmd_ls(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_cat(Shell *shell, UINTN argc, char **argv);
+static void shell_cat_stream(Shell *shell, EFI_FILE_PROTOCOL *file);
+static void shell_cmd_cd(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_pwd(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_mkdir(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_touch(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_cp(Shell *shell, UINTN argc, char **argv);
 static EFI_STATUS shell_copy_file(Shell *shell, const char *src_raw, const char *dst_raw);
-static void shell_cmd_rm(Shell *shell, const char *arg);
-static void shell_cmd_mv(Shell *shell, const char *src_arg, const char *dst_arg);
-static void shell_cmd_hexdump(Shell *shell, const char *arg);
-static void shell_cmd_history(Shell *shell);
-static void shell_cmd_viewbmp(Shell *shell, const char *arg);
-static void shell_cmd_initfs(Shell *shell);
-static void shell_cmd_theme(Shell *shell, const char *arg);
-static void shell_cmd_time(Shell *shell);
-static void shell_cmd_memmap(Shell *shell);
+static void shell_cmd_rm(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_mv(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_hexdump(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_history(Shell *shell, UINTN argc, char **argv);
+static void shell_restore_screen(Shell *shell);
+static void shell_cmd_viewbmp(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_initfs(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_theme(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_time(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_memmap(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_bootstat(Shell *shell, UINTN argc, char **argv);
+static void shell_log_boot(Shell *shell);
+static void shell_append(char *out, UINTN out_len, UINTN *pos, const char *text);
+static void shell_append_u64(char *out, UINTN out_len, UINTN *pos, UINT64 value, UINTN width);
+static void shell_append_timestamp(Shell *shell, char *out, UINTN out_len, UINTN *pos);
+static EFI_FILE_PROTOCOL *shell_open_log(Shell *shell, const char *path, BOOLEAN *is_new);
 static void shell_print_u64(Shell *shell, UINT64 value);
 static void shell_print_padded_u64(Shell *shell, UINT64 value, UINTN width);
 static void shell_print_padded_hex8(Shell *shell, UINT8 value);
@@ -66,16 +142,101 @@ static const char *shell_mem_type_name(UINT32 type);
 static void shell_apply_theme(Shell *shell, UINT32 fg, UINT32 bg, BOOLEAN clear_screen);
 static void shell_save_settings(Shell *shell);
 static void shell_load_settings(Shell *shell);
-static BOOLEAN shell_draw_bmp_centered(Shell *shell, const UINT8 *bmp, UINTN bmp_size);
+static void shell_load_console(Shell *shell, UINT32 sinks);
+static EFI_STATUS shell_read_line_text(Shell *shell, char *line, UINTN max_len);
 static void shell_history_add(Shell *shell, const char *line);
 static void *shell_alloc(Shell *shell, UINTN size);
 static void shell_free(Shell *shell, void *ptr);
+static void *shell_pool_alloc(Shell *shell, UINTN size);
+static void shell_pool_free(Shell *shell, void *ptr);
+static void shell_arena_reset(Shell *shell);
+static EFI_STATUS shell_file_read(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf);
+static EFI_STATUS shell_file_write(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf);
+static void shell_file_close(Shell *shell, EFI_FILE_PROTOCOL *file);
+static EFI_STATUS shell_file_result(Shell *shell, const char *call, EFI_STATUS status);
+static const char *shell_call_method(const char *call);
+static EFI_STATUS shell_image_read(void *ctx, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf);
+static EFI_STATUS shell_image_set_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 position);
+static EFI_STATUS shell_image_get_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 *position);
+static void *shell_image_alloc(void *ctx, UINTN size);
+static void shell_image_free(void *ctx, void *ptr);
+static void shell_flush_events(Shell *shell, BOOLEAN force);
+static void shell_cmd_log(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_trace(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_perf(Shell *shell, UINTN argc, char **argv);
+static void shell_perf_run(Shell *shell, const char *line);
+static BOOLEAN shell_args_text(Shell *shell, UINTN argc, char **argv, char *out, UINTN out_len);
+static void shell_cmd_bench(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_help(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_clear(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_echo(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_info(Shell *shell, UINTN argc, char **argv);
+static void shell_cmd_reboot(Shell *shell, UINTN argc, char **argv);
+
+// Command table, kept sorted by name: shell_find_command binary-searches it
+// and `help` lists it in this order. min_args/max_args count arguments after
+// the command name and are checked before the handler runs.
+static const ShellCommand shell_commands[] = {
+    {"bench", shell_cmd_bench, 0, 0, "bench", "firmware throughput table",
+     "  Measures fill, glyph, scroll, GOP Blt, FAT read/write and\n"
+     "  AllocatePool/AllocatePages rates under the running firmware.\n"
+     "  Uses a 4 MiB scratch file in /HATTEROS/system/tmp; results are\n"
+     "  appended to /HATTEROS/system/log/bench.csv."},
+    {"bootstat", shell_cmd_bootstat, 0, 0, "bootstat", "boot phase timing",
+     "  Per-phase boot time from TSC stamps in efi_main.\n"
+     "  Every boot is appended to /HATTEROS/system/log/boot.csv."},
+    {"cat", shell_cmd_cat, 0, 1, "cat [path]", "print file or piped input",
+     "  With no path, prints what was piped in: ls -l | cat"},
+    {"cd", shell_cmd_cd, 1, 1, "cd <path>", "change current directory", NULL},
+    {"clear", shell_cmd_clear, 0, 0, "clear", "clear the screen", NULL},
+    {"cp", shell_cmd_cp, 2, 2, "cp <src> <dst>", "copy file", NULL},
+    {"echo", shell_cmd_echo, 0, SHELL_ARGS_ANY, "echo <text>", "print text", NULL},
+    {"help", shell_cmd_help, 0, 1, "help [cmd]", "list commands or command help", NULL},
+    {"hexdump", shell_cmd_hexdump, 0, 1, "hexdump [path]", "hex view of file or piped input",
+     "  With no path, dumps what was piped in: cat a.bin | hexdump"},
+    {"history", shell_cmd_history, 0, 0, "history", "show command history", NULL},
+    {"info", shell_cmd_info, 0, 0, "info", "show system info", NULL},
+    {"initfs", shell_cmd_initfs, 0, 0, "initfs", "create /HATTEROS tree",
+     "  Creates /HATTEROS/system/*, /HATTEROS/user/*, /HATTEROS/bin."},
+    {"log", shell_cmd_log, 0, 6, "log [-a] [filter...]", "show the event log",
+     "  Decodes boot, shell and file events from this boot's ring.\n"
+     "  -a reads every boot from /HATTEROS/system/log/events.bin.\n"
+     "  Filters: errors, or subsystems log boot shell file."},
+    {"ls", shell_cmd_ls, 0, 2, "ls [-l] [path]", "list files",
+     "  -l shows type, size, and modified timestamp."},
+    {"memmap", shell_cmd_memmap, 0, 0, "memmap", "summarize memory map", NULL},
+    {"mkdir", shell_cmd_mkdir, 1, 2, "mkdir [-p] <path>", "create directory",
+     "  -p creates missing parent directories."},
+    {"mv", shell_cmd_mv, 2, 2, "mv <src> <dst>", "move/rename file", NULL},
+    {"perf", shell_cmd_perf, 1, SHELL_ARGS_ANY, "perf <command line>", "run a command and report its cost",
+     "  Runs the command, then prints cycles, wall time, shell_alloc\n"
+     "  calls/bytes, file-protocol calls/bytes and glyphs/pixels drawn."},
+    {"pwd", shell_cmd_pwd, 0, 0, "pwd", "print current directory", NULL},
+    {"reboot", shell_cmd_reboot, 0, 0, "reboot", "reboot machine", NULL},
+    {"rm", shell_cmd_rm, 1, 1, "rm <path>", "delete file", NULL},
+    {"theme", shell_cmd_theme, 0, 2, "theme [option]", "shell colors/prompt",
+     "  theme default|light|amber|prompt <full|short>\n"
+     "  Changes are saved to /HATTEROS/system/config/shell.cfg."},
+    {"time", shell_cmd_time, 0, 0, "time", "read UEFI clock", NULL},
+    {"touch", shell_cmd_touch, 1, 1, "touch <path>", "create empty file", NULL},
+    {"trace", shell_cmd_trace, 0, 2, "trace [save <path>|clear]", "export spans for a trace viewer",
+     "  Spans cover boot phases, commands, file protocol calls and\n"
+     "  screen presents since boot (or the last clear). save writes\n"
+     "  Chrome Trace Event JSON, e.g. trace save /trace.json"},
+    {"viewbmp", shell_cmd_viewbmp, 1, 1, "viewbmp <path>", "full-screen BMP/QOI preview",
+     "  Supports QOI and uncompressed 24-bit or 32-bit BMP."},
+};
+
+#define SHELL_COMMAND_COUNT (sizeof(shell_commands) / sizeof(shell_commands[0]))
 
 // Initialize shell state and compute text-grid size from framebuffer dimensions.
-void shell_init(Shell *shell, EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContext *gfx) {
+// console_sinks is a CONSOLE_SINK_* set, or CONSOLE_SINKS_AUTO to use the
+// console config file.
+void shell_init(Shell *shell, EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContext *gfx, UINT32 console_sinks) {
     shell->image_handle = image_handle;
     shell->st = st;
     shell->gfx = gfx;
+    console_init(&shell->console, st, CONSOLE_SINKS_DEFAULT);
     shell->margin_x = 8;
     shell->margin_y = 8;
     shell->fg_color = 0xE8E8E8;
@@ -97,20 +258,170 @@ void shell_init(Shell *shell, EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, Gfx
     shell->cwd[0] = '\\';
     shell->cwd[1] = '\0';
     shell->history_count = 0;
+    shell->volume_root = NULL;
+    for (UINTN i = 0; i < SHELL_DIR_CACHE_MAX; i++) {
+        shell->dir_cache[i].path[0] = '\0';
+        shell->dir_cache[i].handle = NULL;
+        shell->dir_cache[i].last_use = 0;
+    }
+    shell->dir_cache_clock = 0;
+    shell->counters.allocs = 0;
+    shell->counters.pool_allocs = 0;
+    shell->counters.alloc_bytes = 0;
+    for (UINTN i = 0; i < SHELL_ARENA_SLABS; i++) {
+        shell->arena.slabs[i] = NULL;
+        shell->arena.used[i] = 0;
+    }
+    shell->arena.current = 0;
+    shell->arena.last = NULL;
+    shell->arena.pool_count = 0;
+    shell->counters.file_calls = 0;
+    shell->counters.file_read_bytes = 0;
+    shell->counters.file_write_bytes = 0;
+    shell->event_log_failed = FALSE;
+    shell->out = NULL;
+    shell->in = NULL;
+    shell->line = NULL;
+    shell->line_words = NULL;
+    shell_model_init(shell);
+    boot_mark(BOOT_PHASE_SHELL_INIT);
     shell_load_settings(shell);
+    shell_load_console(shell, console_sinks);
+    boot_mark(BOOT_PHASE_SETTINGS);
 
     shell_clear(shell);
 }
 
+// Allocate and blank the scrollback ring. On failure the shell keeps working
+// as a pixel-only console (scroll by rectangle copy, no scrollback).
+static void shell_model_init(Shell *shell) {
+    shell->ring_lines = shell->rows + SHELL_SCROLLBACK_LINES;
+    shell->ring_head = 0;
+    shell->ring_filled = shell->rows;
+    shell->view_offset = 0;
+    shell->scrolls_since_paint = 0;
+    shell->repaint_pending = FALSE;
+
+    // Lives for the whole session, so it bypasses the per-command arena.
+    UINTN cells = shell->ring_lines * shell->cols;
+    shell->cell_chars = (char *)shell_pool_alloc(shell, cells);
+    shell->cell_attrs = (UINT8 *)shell_pool_alloc(shell, cells);
+    if (shell->cell_chars == NULL || shell->cell_attrs == NULL) {
+        shell_pool_free(shell, shell->cell_chars);
+        shell_pool_free(shell, shell->cell_attrs);
+        shell->cell_chars = NULL;
+        shell->cell_attrs = NULL;
+        return;
+    }
+
+    for (UINTN i = 0; i < cells; i++) {
+        shell->cell_chars[i] = ' ';
+        shell->cell_attrs[i] = SHELL_ATTR_NORMAL;
+    }
+}
+
+static UINTN shell_ring_line(Shell *shell, UINTN screen_row) {
+    return (shell->ring_head + screen_row) % shell->ring_lines;
+}
+
+// Advance the ring by one line: the old top row becomes scrollback and a
+// blank line appears at the bottom of the live screen.
+static void shell_model_advance(Shell *shell) {
+    shell->ring_head = (shell->ring_head + 1) % shell->ring_lines;
+    UINTN line = shell_ring_line(shell, shell->rows - 1) * shell->cols;
+    for (UINTN i = 0; i < shell->cols; i++) {
+        shell->cell_chars[line + i] = ' ';
+        shell->cell_attrs[line + i] = SHELL_ATTR_NORMAL;
+    }
+    if (shell->ring_filled < shell->ring_lines) {
+        shell->ring_filled++;
+    }
+}
+
+static void shell_model_write(Shell *shell, UINTN row, UINTN col, const char *text, UINTN n) {
+    if (shell->cell_chars == NULL || row >= shell->rows || col >= shell->cols) {
+        return;
+    }
+    if (n > shell->cols - col) {
+        n = shell->cols - col;
+    }
+    UINTN base = shell_ring_line(shell, row) * shell->cols + col;
+    for (UINTN i = 0; i < n; i++) {
+        shell->cell_chars[base + i] = text[i];
+        shell->cell_attrs[base + i] = SHELL_ATTR_NORMAL;
+    }
+}
+
+// TRUE when pixels on screen track the live model and can be drawn directly.
+static BOOLEAN shell_live_view(Shell *shell) {
+    return !shell->repaint_pending && shell->view_offset == 0;
+}
+
+// Paint every visible row from the model at the current scrollback offset.
+// Only SHELL_ATTR_NORMAL exists today, so each row is a single glyph run.
+static void shell_repaint(Shell *shell) {
+    if (shell->cell_chars == NULL) {
+        return;
+    }
+    trace_begin(TRACE_CAT_GFX, "repaint");
+    for (UINTN row = 0; row < shell->rows; row++) {
+        UINTN line = (shell->ring_head + shell->ring_lines - shell->view_offset + row) % shell->ring_lines;
+        font_draw_run(
+            shell->gfx,
+            shell->margin_x,
+            shell->margin_y + row * FONT_CHAR_HEIGHT,
+            shell->cell_chars + line * shell->cols,
+            shell->cols,
+            shell->fg_color,
+            shell->bg_color
+        );
+    }
+    shell->repaint_pending = FALSE;
+    shell->scrolls_since_paint = 0;
+    trace_end();
+}
+
+static void shell_sync_screen(Shell *shell) {
+    if (shell->repaint_pending) {
+        shell_repaint(shell);
+    }
+}
+
 // Clear the shell viewport and reset cursor to top-left.
+// With the text model, the used part of the screen is pushed into scrollback.
 void shell_clear(Shell *shell) {
-    gfx_clear(shell->gfx, shell->bg_color);
+    if (shell->cell_chars != NULL) {
+        UINTN used = (shell->cursor_row > 0 || shell->cursor_col > 0) ? shell->cursor_row + 1 : 0;
+        for (UINTN i = 0; i < used; i++) {
+            shell_model_advance(shell);
+        }
+        shell->view_offset = 0;
+        shell->repaint_pending = FALSE;
+        shell->scrolls_since_paint = 0;
+    }
+    if ((shell->console.sinks & CONSOLE_SINK_FRAMEBUFFER) != 0) {
+        gfx_clear(shell->gfx, shell->bg_color);
+    }
     shell->cursor_col = 0;
     shell->cursor_row = 0;
 }
 
-// Scroll one text row upward by moving framebuffer pixels directly.
+// Scroll one text row upward.
+// With the text model this only advances the ring head; the screen is
+// repainted from the model lazily (before input, or once per screenful of
+// output so long commands still show progress).
 static void shell_scroll(Shell *shell) {
+    if (shell->cell_chars != NULL) {
+        shell_model_advance(shell);
+        shell->repaint_pending = TRUE;
+        shell->scrolls_since_paint++;
+        if (shell->scrolls_since_paint >= shell->rows) {
+            shell_repaint(shell);
+            gfx_present(shell->gfx);
+        }
+        return;
+    }
+
     GfxContext *gfx = shell->gfx;
     UINTN line_px = FONT_CHAR_HEIGHT;
     if (gfx->height <= shell->margin_y * 2 + line_px || gfx->width <= shell->margin_x * 2) {
@@ -121,13 +432,15 @@ static void shell_scroll(Shell *shell) {
     UINTN right = gfx->width - shell->margin_x;
     UINTN bottom = gfx->height - shell->margin_y;
 
-    for (UINTN y = shell->margin_y; y + line_px < bottom; y++) {
-        UINTN dst_row = y * gfx->pixels_per_scanline;
-        UINTN src_row = (y + line_px) * gfx->pixels_per_scanline;
-        for (UINTN x = shell->margin_x; x < right; x++) {
-            gfx->framebuffer[dst_row + x] = gfx->framebuffer[src_row + x];
-        }
-    }
+    gfx_copy_rect(
+        gfx,
+        shell->margin_x,
+        shell->margin_y + line_px,
+        shell->margin_x,
+        shell->margin_y,
+        right - shell->margin_x,
+        bottom - shell->margin_y - line_px
+    );
 
     UINTN clear_start = bottom - line_px;
     gfx_fill_rect(gfx, shell->margin_x, clear_start, right - shell->margin_x, line_px, shell->bg_color);
@@ -159,38 +472,69 @@ static void shell_set_cursor(Shell *shell, UINTN row, UINTN col) {
     shell->cursor_col = col;
 }
 
-static UINT16 shell_read_le16(const UINT8 *p) {
-    return (UINT16)(p[0] | ((UINT16)p[1] << 8));
-}
+// Store n cells at the cursor (n must fit in the current row), draw them if
+// the screen is live, and advance the cursor.
+static void shell_emit(Shell *shell, const char *text, UINTN n) {
+    shell_model_write(shell, shell->cursor_row, shell->cursor_col, text, n);
+    if (shell_live_view(shell)) {
+        UINTN px = shell->margin_x + shell->cursor_col * FONT_CHAR_WIDTH;
+        UINTN py = shell->margin_y + shell->cursor_row * FONT_CHAR_HEIGHT;
+        font_draw_run(shell->gfx, px, py, text, n, shell->fg_color, shell->bg_color);
+    }
 
-static UINT32 shell_read_le32(const UINT8 *p) {
-    return (UINT32)(p[0] |
-                    ((UINT32)p[1] << 8) |
-                    ((UINT32)p[2] << 16) |
-                    ((UINT32)p[3] << 24));
+    shell->cursor_col += n;
+    if (shell->cursor_col >= shell->cols) {
+        shell_newline(shell);
+    }
 }
 
 // Render one printable character into the shell grid.
 static void shell_putc(Shell *shell, char c) {
-    if (c == '\n') {
-        shell_newline(shell);
+    if (shell->out != NULL) {
+        shell_stream_write(shell, shell->out, &c, 1);
         return;
     }
-
-    UINTN px = shell->margin_x + shell->cursor_col * FONT_CHAR_WIDTH;
-    UINTN py = shell->margin_y + shell->cursor_row * FONT_CHAR_HEIGHT;
-    font_draw_char(shell->gfx, px, py, c, shell->fg_color, shell->bg_color, 1, FALSE);
-
-    shell->cursor_col++;
-    if (shell->cursor_col >= shell->cols) {
+    if ((shell->console.sinks & ~CONSOLE_SINK_FRAMEBUFFER) != 0) {
+        console_write(&shell->console, &c, 1);
+    }
+    if ((shell->console.sinks & CONSOLE_SINK_FRAMEBUFFER) == 0) {
+        return;
+    }
+    if (c == '\n') {
         shell_newline(shell);
+        return;
     }
+    shell_emit(shell, &c, 1);
 }
 
 // Print a string without implicit newline.
+// Text is split at newlines and row ends; each piece is drawn as one run.
 void shell_print(Shell *shell, const char *text) {
+    if (shell->out != NULL) {
+        shell_stream_write(shell, shell->out, text, u_strlen(text));
+        return;
+    }
+    if ((shell->console.sinks & ~CONSOLE_SINK_FRAMEBUFFER) != 0) {
+        console_write(&shell->console, text, u_strlen(text));
+    }
+    if ((shell->console.sinks & CONSOLE_SINK_FRAMEBUFFER) == 0) {
+        return;
+    }
     while (*text) {
-        shell_putc(shell, *text++);
+        if (*text == '\n') {
+            shell_newline(shell);
+            text++;
+            continue;
+        }
+
+        UINTN room = shell->cols - shell->cursor_col;
+        UINTN n = 0;
+        while (n < room && text[n] != '\0' && text[n] != '\n') {
+            n++;
+        }
+
+        shell_emit(shell, text, n);
+        text += n;
     }
 }
 
@@ -254,12 +598,26 @@ static void shell_redraw_input(
 ) {
     UINTN px = shell->margin_x + col * FONT_CHAR_WIDTH;
     UINTN py = shell->margin_y + row * FONT_CHAR_HEIGHT;
-    gfx_fill_rect(shell->gfx, px, py, field_len * FONT_CHAR_WIDTH, FONT_CHAR_HEIGHT, shell->bg_color);
+    if (len > field_len) {
+        len = field_len;
+    }
 
-    shell_set_cursor(shell, row, col);
-    for (UINTN i = 0; i < len; i++) {
-        shell_putc(shell, line[i]);
+    // Keep the model in sync so the committed line survives into scrollback.
+    shell_model_write(shell, row, col, line, len);
+    for (UINTN i = len; i < field_len; i++) {
+        shell_model_write(shell, row, col + i, " ", 1);
     }
+
+    // Draw the text as one run, then blank only the unused tail of the field.
+    font_draw_run(shell->gfx, px, py, line, len, shell->fg_color, shell->bg_color);
+    gfx_fill_rect(
+        shell->gfx,
+        px + len * FONT_CHAR_WIDTH,
+        py,
+        (field_len - len) * FONT_CHAR_WIDTH,
+        FONT_CHAR_HEIGHT,
+        shell->bg_color
+    );
     shell_set_cursor(shell, row, col + cursor);
 
     if (show_cursor) {
@@ -282,8 +640,31 @@ static void shell_draw_cursor(Shell *shell, UINTN row, UINTN col) {
     gfx_fill_rect(shell->gfx, px, py, FONT_CHAR_WIDTH, 2, shell->fg_color);
 }
 
+// Move the view one page (rows - 1 lines) into or out of scrollback.
+static void shell_page_scrollback(Shell *shell, BOOLEAN up) {
+    if (shell->cell_chars == NULL) {
+        return;
+    }
+
+    UINTN max_offset = shell->ring_filled - shell->rows;
+    UINTN step = (shell->rows > 1) ? (shell->rows - 1) : 1;
+    UINTN offset = shell->view_offset;
+    if (up) {
+        offset = (offset + step > max_offset) ? max_offset : (offset + step);
+    } else {
+        offset = (offset > step) ? (offset - step) : 0;
+    }
+    if (offset == shell->view_offset) {
+        return;
+    }
+
+    shell->view_offset = offset;
+    shell_repaint(shell);
+}
+
 // Blocking line editor using UEFI keyboard input.
-// Supports printable ASCII insertion, left/right movement, history (up/down), and backspace.
+// Supports printable ASCII insertion, left/right movement, history (up/down),
+// backspace, and PageUp/PageDown to browse scrollback.
 static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
     if (shell == NULL || shell->st == NULL || shell->st->BootServices == NULL || shell->st->ConIn == NULL) {
         return EFI_UNSUPPORTED;
@@ -291,6 +672,9 @@ static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
     if (line == NULL || max_len < 2) {
         return EFI_INVALID_PARAMETER;
     }
+    if ((shell->console.sinks & CONSOLE_SINK_FRAMEBUFFER) == 0) {
+        return shell_read_line_text(shell, line, max_len);
+    }
 
     UINTN start_row = shell->cursor_row;
     UINTN start_col = shell->cursor_col;
@@ -304,9 +688,14 @@ static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
     UINTN cursor = 0;
     INTN history_nav = -1;
     line[0] = '\0';
+    shell_sync_screen(shell);
     shell_redraw_input(shell, start_row, start_col, field_len, line, len, cursor, TRUE);
 
     while (1) {
+        // Flush everything drawn since the last key before blocking on input.
+        gfx_present(shell->gfx);
+        console_flush(&shell->console);
+
         UINTN idx;
         EFI_EVENT event = shell->st->ConIn->WaitForKey;
         EFI_STATUS status = uefi_call_wrapper(shell->st->BootServices->WaitForEvent, 3, 1, &event, &idx);
@@ -320,6 +709,20 @@ static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
             continue;
         }
 
+        if (key.ScanCode == SCAN_PAGE_UP || key.ScanCode == SCAN_PAGE_DOWN) {
+            shell_page_scrollback(shell, key.ScanCode == SCAN_PAGE_UP);
+            if (shell->view_offset == 0) {
+                shell_redraw_input(shell, start_row, start_col, field_len, line, len, cursor, TRUE);
+            }
+            continue;
+        }
+        if (shell->view_offset != 0) {
+            // Any other key returns to the live screen before it is handled.
+            shell->view_offset = 0;
+            shell_repaint(shell);
+            shell_redraw_input(shell, start_row, start_col, field_len, line, len, cursor, TRUE);
+        }
+
         if (key.ScanCode == SCAN_UP || key.ScanCode == SCAN_DOWN || key.ScanCode == SCAN_LEFT || key.ScanCode == SCAN_RIGHT) {
             if (key.ScanCode == SCAN_LEFT) {
                 if (cursor > 0) {
@@ -380,6 +783,11 @@ static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
             // Remove caret before committing the line so printed text remains clean.
             shell_redraw_input(shell, start_row, start_col, field_len, line, len, cursor, FALSE);
             shell_set_cursor(shell, start_row, start_col + len);
+            // The editor draws straight to the framebuffer; mirror the
+            // committed line to the text sinks.
+            if ((shell->console.sinks & ~CONSOLE_SINK_FRAMEBUFFER) != 0) {
+                console_write(&shell->console, line, len);
+            }
             shell_putc(shell, '\n');
             return EFI_SUCCESS;
         }
@@ -412,24 +820,258 @@ static EFI_STATUS shell_read_line(Shell *shell, char *line, UINTN max_len) {
     }
 }
 
+// Line input without the framebuffer: typed characters are echoed through
+// the text sinks and only append/backspace and history recall are supported.
+static EFI_STATUS shell_read_line_text(Shell *shell, char *line, UINTN max_len) {
+    UINTN len = 0;
+    INTN history_nav = -1;
+    line[0] = '\0';
+
+    while (1) {
+        console_flush(&shell->console);
+
+        UINTN idx;
+        EFI_EVENT event = shell->st->ConIn->WaitForKey;
+        EFI_STATUS status = uefi_call_wrapper(shell->st->BootServices->WaitForEvent, 3, 1, &event, &idx);
+        if (EFI_ERROR(status)) {
+            return status;
+        }
+
+        EFI_INPUT_KEY key;
+        status = uefi_call_wrapper(shell->st->ConIn->ReadKeyStroke, 2, shell->st->ConIn, &key);
+        if (EFI_ERROR(status)) {
+            continue;
+        }
+
+        if ((key.ScanCode == SCAN_UP || key.ScanCode == SCAN_DOWN) && shell->history_count > 0) {
+            if (key.ScanCode == SCAN_UP) {
+                history_nav = (history_nav < 0) ? (INTN)shell->history_count - 1 : ((history_nav > 0) ? history_nav - 1 : 0);
+            } else if (history_nav >= 0 && (UINTN)history_nav + 1 < shell->history_count) {
+                history_nav++;
+            } else {
+                history_nav = -1;
+            }
+
+            for (; len > 0; len--) {
+                shell_print(shell, "\b \b");
+            }
+            const char *entry = (history_nav >= 0) ? shell->history[history_nav] : "";
+            while (entry[len] != '\0' && len + 1 < max_len) {
+                line[len] = entry[len];
+                len++;
+            }
+            line[len] = '\0';
+            shell_print(shell, line);
+            continue;
+        }
+
+        CHAR16 uc = key.UnicodeChar;
+        if (uc == (CHAR16)'\r') {
+            shell_putc(shell, '\n');
+            return EFI_SUCCESS;
+        }
+        if (uc == (CHAR16)'\b') {
+            if (len > 0) {
+                line[--len] = '\0';
+                history_nav = -1;
+                shell_print(shell, "\b \b");
+            }
+            continue;
+        }
+        if (uc >= 32 && uc <= 126 && len + 1 < max_len) {
+            line[len++] = (char)uc;
+            line[len] = '\0';
+            history_nav = -1;
+            shell_putc(shell, (char)uc);
+        }
+    }
+}
+
 // Small wrappers over BootServices AllocatePool/FreePool for convenience.
-static void *shell_alloc(Shell *shell, UINTN size) {
+static void *shell_pool_alloc(Shell *shell, UINTN size) {
     if (shell == NULL || shell->st == NULL || shell->st->BootServices == NULL) {
         return NULL;
     }
     void *ptr = NULL;
+    shell->counters.pool_allocs++;
     EFI_STATUS status = uefi_call_wrapper(shell->st->BootServices->AllocatePool, 3, EfiLoaderData, size, &ptr);
-    if (EFI_ERROR(status)) {
+    return EFI_ERROR(status) ? NULL : ptr;
+}
+
+static void shell_pool_free(Shell *shell, void *ptr) {
+    if (ptr == NULL || shell == NULL || shell->st == NULL || shell->st->BootServices == NULL) {
+        return;
+    }
+    uefi_call_wrapper(shell->st->BootServices->FreePool, 1, ptr);
+}
+
+// Bump-allocate from the current slab, moving to (and allocating) the next
+// slab when it is full. Returns NULL once every slab is in use.
+static void *shell_arena_take(Shell *shell, UINTN size) {
+    ShellArena *arena = &shell->arena;
+    while (arena->current < SHELL_ARENA_SLABS) {
+        UINTN i = arena->current;
+        if (arena->slabs[i] == NULL) {
+            EFI_PHYSICAL_ADDRESS addr = 0;
+            EFI_STATUS status = uefi_call_wrapper(
+                shell->st->BootServices->AllocatePages, 4, AllocateAnyPages, EfiLoaderData, SHELL_ARENA_SLAB_PAGES, &addr
+            );
+            if (EFI_ERROR(status)) {
+                return NULL;
+            }
+            arena->slabs[i] = (UINT8 *)(UINTN)addr;
+            arena->used[i] = 0;
+        }
+        if (size <= SHELL_ARENA_SLAB_BYTES - arena->used[i]) {
+            void *ptr = arena->slabs[i] + arena->used[i];
+            arena->used[i] += size;
+            arena->last = ptr;
+            return ptr;
+        }
+        arena->current++;
+    }
+    return NULL;
+}
+
+// Allocation for the running command. Memory comes from the arena and is
+// reclaimed wholesale by shell_arena_reset after the command line finishes,
+// so error paths cannot leak. Requests over SHELL_ARENA_LARGE, or once the
+// slabs are full, go to the pool and are tracked so the reset frees them.
+static void *shell_alloc(Shell *shell, UINTN size) {
+    if (shell == NULL || shell->st == NULL || shell->st->BootServices == NULL) {
         return NULL;
     }
+    shell->counters.allocs++;
+
+    void *ptr = NULL;
+    if (size <= SHELL_ARENA_LARGE) {
+        ptr = shell_arena_take(shell, (size + SHELL_ARENA_ALIGN - 1) & ~(UINTN)(SHELL_ARENA_ALIGN - 1));
+    }
+    if (ptr == NULL) {
+        if (shell->arena.pool_count == SHELL_ARENA_POOL_MAX) {
+            return NULL;
+        }
+        ptr = shell_pool_alloc(shell, size);
+        if (ptr == NULL) {
+            return NULL;
+        }
+        shell->arena.pool[shell->arena.pool_count++] = ptr;
+    }
+    shell->counters.alloc_bytes += size;
     return ptr;
 }
 
+// Arena memory is only given back by the reset, except that freeing the
+// most recent allocation rewinds it, so grow-and-retry loops reuse space.
+// Pool blocks are freed now.
 static void shell_free(Shell *shell, void *ptr) {
-    if (ptr == NULL || shell == NULL || shell->st == NULL || shell->st->BootServices == NULL) {
+    if (ptr == NULL || shell == NULL) {
         return;
     }
-    uefi_call_wrapper(shell->st->BootServices->FreePool, 1, ptr);
+
+    ShellArena *arena = &shell->arena;
+    for (UINTN i = 0; i < SHELL_ARENA_SLABS; i++) {
+        UINT8 *p = (UINT8 *)ptr;
+        if (arena->slabs[i] != NULL && p >= arena->slabs[i] && p < arena->slabs[i] + SHELL_ARENA_SLAB_BYTES) {
+            if (ptr == arena->last && i == arena->current) {
+                arena->used[i] = (UINTN)(p - arena->slabs[i]);
+                arena->last = NULL;
+            }
+            return;
+        }
+    }
+
+    for (UINTN i = 0; i < arena->pool_count; i++) {
+        if (arena->pool[i] == ptr) {
+            arena->pool[i] = arena->pool[--arena->pool_count];
+            break;
+        }
+    }
+    shell_pool_free(shell, ptr);
+}
+
+static void shell_arena_reset(Shell *shell) {
+    ShellArena *arena = &shell->arena;
+    while (arena->pool_count > 0) {
+        shell_pool_free(shell, arena->pool[--arena->pool_count]);
+    }
+    for (UINTN i = 0; i < SHELL_ARENA_SLABS; i++) {
+        arena->used[i] = 0;
+    }
+    arena->current = 0;
+    arena->last = NULL;
+}
+
+// Counted wrappers for the firmware file calls that move data.
+static EFI_STATUS shell_file_read(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf) {
+    EFI_STATUS status = SHELL_FILE_CALL(shell, file->Read, 3, file, size, buf);
+    if (!EFI_ERROR(status)) {
+        shell->counters.file_read_bytes += *size;
+    }
+    return status;
+}
+
+static EFI_STATUS shell_file_write(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf) {
+    EFI_STATUS status = SHELL_FILE_CALL(shell, file->Write, 3, file, size, buf);
+    if (!EFI_ERROR(status)) {
+        shell->counters.file_write_bytes += *size;
+    }
+    return status;
+}
+
+static void shell_file_close(Shell *shell, EFI_FILE_PROTOCOL *file) {
+    SHELL_FILE_CALL(shell, file->Close, 1, file);
+}
+
+// ImageIo callbacks, so image decoding shows up in the counters and trace
+// and allocates from the command arena like any other command.
+static EFI_STATUS shell_image_read(void *ctx, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf) {
+    return shell_file_read((Shell *)ctx, file, size, buf);
+}
+
+static EFI_STATUS shell_image_set_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 position) {
+    return SHELL_FILE_CALL((Shell *)ctx, file->SetPosition, 2, file, position);
+}
+
+static EFI_STATUS shell_image_get_position(void *ctx, EFI_FILE_PROTOCOL *file, UINT64 *position) {
+    return SHELL_FILE_CALL((Shell *)ctx, file->GetPosition, 2, file, position);
+}
+
+static void *shell_image_alloc(void *ctx, UINTN size) {
+    return shell_alloc((Shell *)ctx, size);
+}
+
+static void shell_image_free(void *ctx, void *ptr) {
+    shell_free((Shell *)ctx, ptr);
+}
+
+// `call` is a stringized member expression from SHELL_FILE_CALL, e.g.
+// "dir->Open"; return the method name after the last '>'.
+static const char *shell_call_method(const char *call) {
+    const char *method = call;
+    for (const char *c = call; *c != '\0'; c++) {
+        if (*c == '>') {
+            method = c + 1;
+        }
+    }
+    return method;
+}
+
+static EFI_STATUS shell_file_result(Shell *shell, const char *call, EFI_STATUS status) {
+    trace_end();
+    shell->counters.file_calls++;
+    // Size probes (GetInfo with no buffer) fail by design.
+    if (EFI_ERROR(status) && status != EFI_BUFFER_TOO_SMALL) {
+        const char *method = shell_call_method(call);
+        // Opening a missing file is an answer, not a fault: optional config
+        // files are probed at every boot, and a bad user path is already
+        // logged by shell_print_error_status.
+        if (status == EFI_NOT_FOUND && u_strcmp(method, "Open") == 0) {
+            return status;
+        }
+        evlog_write(EVLOG_SYS_FILE, EVLOG_LEVEL_ERROR, EVLOG_FILE_ERROR, (UINT64)status, evlog_tag(method));
+    }
+    return status;
 }
 
 static const char *shell_status_str(EFI_STATUS status) {
@@ -459,7 +1101,13 @@ static const char *shell_status_str(EFI_STATUS status) {
     }
 }
 
+// Errors always go to the console, even from a piped or redirected command.
 static void shell_print_error_status(Shell *shell, const char *prefix, EFI_STATUS status) {
+    evlog_write(EVLOG_SYS_SHELL, EVLOG_LEVEL_ERROR, EVLOG_SHELL_ERROR, (UINT64)status, evlog_tag(prefix));
+
+    ShellStream *out = shell->out;
+    shell->out = NULL;
+
     char code[32];
     u_u64_to_hex((UINT64)status, code, sizeof(code));
     shell_print(shell, prefix);
@@ -468,6 +1116,8 @@ static void shell_print_error_status(Shell *shell, const char *prefix, EFI_STATU
     shell_print(shell, " (");
     shell_print(shell, code);
     shell_println(shell, ")");
+
+    shell->out = out;
 }
 
 static void shell_print_u64(Shell *shell, UINT64 value) {
@@ -519,8 +1169,15 @@ static const char *shell_mem_type_name(UINT32 type) {
 static void shell_apply_theme(Shell *shell, UINT32 fg, UINT32 bg, BOOLEAN clear_screen) {
     shell->fg_color = fg;
     shell->bg_color = bg;
+    font_cache_invalidate();
     if (clear_screen) {
-        shell_clear(shell);
+        if (shell->cell_chars != NULL) {
+            // Repaint existing text in the new colors instead of dropping it.
+            gfx_clear(shell->gfx, shell->bg_color);
+            shell_repaint(shell);
+        } else {
+            shell_clear(shell);
+        }
     }
 }
 
@@ -552,7 +1209,7 @@ static void shell_save_settings(Shell *shell) {
         EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
         info->FileSize = 0;
         info->PhysicalSize = 0;
-        uefi_call_wrapper(cfg->SetInfo, 4, cfg, &file_info_guid, info->Size, info);
+        SHELL_FILE_CALL(shell, cfg->SetInfo, 4, cfg, &file_info_guid, info->Size, info);
         shell_free(shell, info);
     }
 
@@ -566,10 +1223,10 @@ static void shell_save_settings(Shell *shell) {
     data.reserved[1] = 0;
     data.reserved[2] = 0;
 
-    uefi_call_wrapper(cfg->SetPosition, 2, cfg, 0);
+    SHELL_FILE_CALL(shell, cfg->SetPosition, 2, cfg, 0);
     UINTN write_size = sizeof(data);
-    uefi_call_wrapper(cfg->Write, 3, cfg, &write_size, &data);
-    uefi_call_wrapper(cfg->Close, 1, cfg);
+    shell_file_write(shell, cfg, &write_size, &data);
+    shell_file_close(shell, cfg);
 }
 
 static void shell_load_settings(Shell *shell) {
@@ -585,8 +1242,8 @@ static void shell_load_settings(Shell *shell) {
 
     ShellConfigFile data;
     UINTN read_size = sizeof(data);
-    status = uefi_call_wrapper(cfg->Read, 3, cfg, &read_size, &data);
-    uefi_call_wrapper(cfg->Close, 1, cfg);
+    status = shell_file_read(shell, cfg, &read_size, &data);
+    shell_file_close(shell, cfg);
     if (EFI_ERROR(status) || read_size < sizeof(data)) {
         return;
     }
@@ -600,76 +1257,31 @@ static void shell_load_settings(Shell *shell) {
     shell->prompt_show_path = (data.prompt_show_path != 0);
 }
 
-static BOOLEAN shell_draw_bmp_centered(Shell *shell, const UINT8 *bmp, UINTN bmp_size) {
-    if (shell == NULL || shell->gfx == NULL || bmp == NULL || bmp_size < 54) {
-        return FALSE;
-    }
-    if (bmp[0] != 'B' || bmp[1] != 'M') {
-        return FALSE;
-    }
-
-    UINT32 pixel_offset = shell_read_le32(bmp + 10);
-    UINT32 dib_size = shell_read_le32(bmp + 14);
-    INT32 width = (INT32)shell_read_le32(bmp + 18);
-    INT32 height = (INT32)shell_read_le32(bmp + 22);
-    UINT16 planes = shell_read_le16(bmp + 26);
-    UINT16 bits_per_pixel = shell_read_le16(bmp + 28);
-    UINT32 compression = shell_read_le32(bmp + 30);
-
-    if (dib_size < 40 || width <= 0 || height == 0 || planes != 1) {
-        return FALSE;
-    }
-    if (compression != 0 || (bits_per_pixel != 24 && bits_per_pixel != 32)) {
-        return FALSE;
-    }
-
-    UINTN img_w = (UINTN)width;
-    UINTN img_h = (height < 0) ? (UINTN)(-height) : (UINTN)height;
-    UINTN bpp = bits_per_pixel / 8;
-    UINTN row_stride = (img_w * bpp + 3) & ~(UINTN)3;
-    if (pixel_offset > bmp_size || img_h > ((UINTN)-1) / row_stride) {
-        return FALSE;
-    }
-    if ((row_stride * img_h) > (bmp_size - pixel_offset)) {
-        return FALSE;
-    }
-
-    UINTN src_x = 0;
-    UINTN src_y = 0;
-    UINTN draw_w = img_w;
-    UINTN draw_h = img_h;
-    UINTN dst_x = 0;
-    UINTN dst_y = 0;
-
-    if (draw_w > shell->gfx->width) {
-        src_x = (draw_w - shell->gfx->width) / 2;
-        draw_w = shell->gfx->width;
-    } else {
-        dst_x = (shell->gfx->width - draw_w) / 2;
-    }
-    if (draw_h > shell->gfx->height) {
-        src_y = (draw_h - shell->gfx->height) / 2;
-        draw_h = shell->gfx->height;
-    } else {
-        dst_y = (shell->gfx->height - draw_h) / 2;
-    }
-
-    const UINT8 *pixel_base = bmp + pixel_offset;
-    BOOLEAN top_down = (height < 0);
-    for (UINTN y = 0; y < draw_h; y++) {
-        UINTN src_row = src_y + y;
-        UINTN bmp_row = top_down ? src_row : (img_h - 1 - src_row);
-        const UINT8 *row = pixel_base + bmp_row * row_stride;
-        const UINT8 *src = row + src_x * bpp;
-        for (UINTN x = 0; x < draw_w; x++) {
-            UINT8 b = src[x * bpp + 0];
-            UINT8 g = src[x * bpp + 1];
-            UINT8 r = src[x * bpp + 2];
-            gfx_put_pixel(shell->gfx, dst_x + x, dst_y + y, ((UINT32)r << 16) | ((UINT32)g << 8) | b);
+// Pick the console sinks: the boot key's choice if any, else the words in
+// console.cfg (e.g. "framebuffer serial"), else the framebuffer alone. The
+// log sink appends to console.log and is dropped if that cannot be opened.
+static void shell_load_console(Shell *shell, UINT32 sinks) {
+    if (sinks == CONSOLE_SINKS_AUTO) {
+        sinks = CONSOLE_SINKS_DEFAULT;
+
+        EFI_FILE_PROTOCOL *cfg = NULL;
+        if (!EFI_ERROR(shell_open_path(shell, SHELL_CONSOLE_CFG_PATH, EFI_FILE_MODE_READ, 0, &cfg)) && cfg != NULL) {
+            char text[128];
+            UINTN size = sizeof(text);
+            UINT32 parsed = 0;
+            if (!EFI_ERROR(shell_file_read(shell, cfg, &size, text)) &&
+                console_parse_sinks(text, size, &parsed)) {
+                sinks = parsed;
+            }
+            shell_file_close(shell, cfg);
         }
     }
 
-    return TRUE;
+    console_init(&shell->console, shell->st, sinks);
+    if ((sinks & CONSOLE_SINK_LOG) != 0) {
+        BOOLEAN is_new = FALSE;
+        console_attach_log(&shell->console, shell_open_log(shell, SHELL_CONSOLE_LOG_PATH, &is_new));
+    }
 }
 
 static EFI_STATUS shell_ensure_dir(Shell *shell, const char *path) {
@@ -682,7 +1294,7 @@ static EFI_STATUS shell_ensure_dir(Shell *shell, const char *path) {
         &dir
     );
     if (!EFI_ERROR(status) && dir != NULL) {
-        uefi_call_wrapper(dir->Close, 1, dir);
+        shell_file_close(shell, dir);
     }
     return status;
 }
@@ -743,40 +1355,6 @@ static EFI_STATUS shell_ensure_dir_tree(Shell *shell, const char *path) {
     return EFI_SUCCESS;
 }
 
-static BOOLEAN shell_parse_ls_args(const char *arg, BOOLEAN *long_mode, char *path_out, UINTN path_out_len) {
-    if (long_mode == NULL || path_out == NULL || path_out_len < 2) {
-        return FALSE;
-    }
-
-    *long_mode = FALSE;
-    path_out[0] = '.';
-    path_out[1] = '\0';
-
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        return TRUE;
-    }
-
-    if (u_strcmp(raw, "-l") == 0) {
-        *long_mode = TRUE;
-        return TRUE;
-    }
-
-    if (u_startswith(raw, "-l ")) {
-        *long_mode = TRUE;
-        raw = u_trim_left((char *)(raw + 2));
-    }
-
-    UINTN i = 0;
-    while (raw[i] != '\0' && i + 1 < path_out_len) {
-        path_out[i] = raw[i];
-        i++;
-    }
-    path_out[i] = '\0';
-    return TRUE;
-}
-
 static void shell_print_history(Shell *shell) {
     if (shell->history_count == 0) {
         shell_println(shell, "history: empty");
@@ -791,68 +1369,51 @@ static void shell_print_history(Shell *shell) {
 
 static void shell_print_help(Shell *shell, const char *topic) {
     if (topic == NULL || topic[0] == '\0') {
+        UINTN width = 0;
+        for (UINTN i = 0; i < SHELL_COMMAND_COUNT; i++) {
+            UINTN len = u_strlen(shell_commands[i].usage);
+            width = (len > width) ? len : width;
+        }
+
         shell_println(shell, "Commands:");
-        shell_println(shell, "  help [cmd]      - list commands or command help");
-        shell_println(shell, "  clear           - clear the screen");
-        shell_println(shell, "  echo <text>     - print text");
-        shell_println(shell, "  pwd             - print current directory");
-        shell_println(shell, "  cd <path>       - change current directory");
-        shell_println(shell, "  ls [-l] [path]  - list files");
-        shell_println(shell, "  cat <path>      - print file contents");
-        shell_println(shell, "  mkdir [-p] <p>  - create directory");
-        shell_println(shell, "  touch <p>       - create empty file");
-        shell_println(shell, "  cp <s> <d>      - copy file");
-        shell_println(shell, "  rm <path>       - delete file");
-        shell_println(shell, "  mv <s> <d>      - move/rename file");
-        shell_println(shell, "  hexdump <path>  - hex view of file");
-        shell_println(shell, "  history         - show command history");
-        shell_println(shell, "  viewbmp <path>  - full-screen BMP preview");
-        shell_println(shell, "  initfs          - create /HATTEROS tree");
-        shell_println(shell, "  theme ...       - shell colors/prompt");
-        shell_println(shell, "  time            - read UEFI clock");
-        shell_println(shell, "  memmap          - summarize memory map");
-        shell_println(shell, "  info            - show system info");
-        shell_println(shell, "  reboot          - reboot machine");
+        for (UINTN i = 0; i < SHELL_COMMAND_COUNT; i++) {
+            shell_print(shell, "  ");
+            shell_print(shell, shell_commands[i].usage);
+            for (UINTN len = u_strlen(shell_commands[i].usage); len < width; len++) {
+                shell_putc(shell, ' ');
+            }
+            shell_print(shell, " - ");
+            shell_println(shell, shell_commands[i].summary);
+        }
         return;
     }
 
-    if (u_strcmp(topic, "ls") == 0) {
-        shell_println(shell, "ls [-l] [path]");
-        shell_println(shell, "  -l shows type, size, and modified timestamp.");
+    const ShellCommand *command = shell_find_command(topic);
+    if (command == NULL) {
+        shell_print(shell, "No detailed help for: ");
+        shell_println(shell, topic);
         return;
     }
-    if (u_strcmp(topic, "mkdir") == 0) {
-        shell_println(shell, "mkdir [-p] <path>");
-        shell_println(shell, "  -p creates missing parent directories.");
-        return;
-    }
-    if (u_strcmp(topic, "theme") == 0) {
-        shell_println(shell, "theme default|light|amber|prompt <full|short>");
-        shell_println(shell, "  Changes are saved to /HATTEROS/system/config/shell.cfg.");
-        return;
-    }
-    if (u_strcmp(topic, "initfs") == 0) {
-        shell_println(shell, "initfs");
-        shell_println(shell, "  Creates /HATTEROS/system/*, /HATTEROS/user/*, /HATTEROS/bin.");
-        return;
-    }
-    if (u_strcmp(topic, "viewbmp") == 0) {
-        shell_println(shell, "viewbmp <path>");
-        shell_println(shell, "  Supports uncompressed 24-bit or 32-bit BMP.");
-        return;
+    shell_println(shell, command->usage);
+    shell_print(shell, "  ");
+    shell_println(shell, command->summary);
+    if (command->detail != NULL) {
+        shell_println(shell, command->detail);
     }
-
-    shell_print(shell, "No detailed help for: ");
-    shell_println(shell, topic);
 }
 
-// Open ESP root directory where this EFI app was loaded from.
+// Return the ESP root directory where this EFI app was loaded from. The volume
+// is opened once per session and the handle stays owned by the shell; callers
+// must not Close it.
 static EFI_STATUS shell_open_root(Shell *shell, EFI_FILE_PROTOCOL **root) {
     if (root == NULL) {
         return EFI_INVALID_PARAMETER;
     }
 
-    *root = NULL;
+    *root = shell->volume_root;
+    if (*root != NULL) {
+        return EFI_SUCCESS;
+    }
 
     EFI_GUID loaded_image_guid = EFI_LOADED_IMAGE_PROTOCOL_GUID;
     EFI_GUID sfs_guid = EFI_SIMPLE_FILE_SYSTEM_PROTOCOL_GUID;
@@ -881,9 +1442,104 @@ static EFI_STATUS shell_open_root(Shell *shell, EFI_FILE_PROTOCOL **root) {
         return EFI_NOT_FOUND;
     }
 
-    return uefi_call_wrapper(fs->OpenVolume, 2, fs, root);
+    status = SHELL_FILE_CALL(shell, fs->OpenVolume, 2, fs, &shell->volume_root);
+    if (EFI_ERROR(status)) {
+        shell->volume_root = NULL;
+        return status;
+    }
+    *root = shell->volume_root;
+    return EFI_SUCCESS;
+}
+
+// Close every cached directory handle and the volume root. Used when the
+// firmware reports the media changed, so stale handles are not reused.
+static void shell_dir_cache_flush(Shell *shell) {
+    for (UINTN i = 0; i < SHELL_DIR_CACHE_MAX; i++) {
+        ShellDirCacheEntry *e = &shell->dir_cache[i];
+        if (e->handle != NULL) {
+            shell_file_close(shell, e->handle);
+            e->handle = NULL;
+            e->path[0] = '\0';
+        }
+    }
+    if (shell->volume_root != NULL) {
+        shell_file_close(shell, shell->volume_root);
+        shell->volume_root = NULL;
+    }
+}
+
+// Return an open handle for absolute directory `dir_path` (owned by the cache).
+// Misses open the directory relative to the deepest cached ancestor and evict
+// the least recently used entry.
+static EFI_STATUS shell_dir_cache_get(Shell *shell, const char *dir_path, EFI_FILE_PROTOCOL **out) {
+    EFI_FILE_PROTOCOL *base = NULL;
+    EFI_STATUS status = shell_open_root(shell, &base);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+    if (dir_path[0] == '\\' && dir_path[1] == '\0') {
+        *out = base;
+        return EFI_SUCCESS;
+    }
+
+    UINTN base_len = 1;
+    ShellDirCacheEntry *victim = &shell->dir_cache[0];
+    shell->dir_cache_clock++;
+    for (UINTN i = 0; i < SHELL_DIR_CACHE_MAX; i++) {
+        ShellDirCacheEntry *e = &shell->dir_cache[i];
+        if (e->handle == NULL) {
+            if (victim->handle != NULL) {
+                victim = e;
+            }
+            continue;
+        }
+        if (u_strcmp(e->path, dir_path) == 0) {
+            e->last_use = shell->dir_cache_clock;
+            *out = e->handle;
+            return EFI_SUCCESS;
+        }
+
+        UINTN len = u_strlen(e->path);
+        if (len > base_len && u_strncmp(e->path, dir_path, len) == 0 && dir_path[len] == '\\') {
+            base = e->handle;
+            base_len = len;
+        }
+        if (victim->handle != NULL && e->last_use < victim->last_use) {
+            victim = e;
+        }
+    }
+
+    const char *rel = dir_path + base_len;
+    if (*rel == '\\') {
+        rel++;
+    }
+    CHAR16 rel16[SHELL_PATH_MAX];
+    if (!shell_path_to_char16(rel, rel16, SHELL_PATH_MAX)) {
+        return EFI_INVALID_PARAMETER;
+    }
+
+    EFI_FILE_PROTOCOL *dir = NULL;
+    status = SHELL_FILE_CALL(shell, base->Open, 5, base, &dir, rel16, EFI_FILE_MODE_READ, 0);
+    if (EFI_ERROR(status) || dir == NULL) {
+        return EFI_ERROR(status) ? status : EFI_NOT_FOUND;
+    }
+
+    if (victim->handle != NULL) {
+        shell_file_close(shell, victim->handle);
+    }
+    UINTN i = 0;
+    while (dir_path[i] != '\0' && i + 1 < sizeof(victim->path)) {
+        victim->path[i] = dir_path[i];
+        i++;
+    }
+    victim->path[i] = '\0';
+    victim->handle = dir;
+    victim->last_use = shell->dir_cache_clock;
+    *out = dir;
+    return EFI_SUCCESS;
 }
 
+// Open `path` (relative to cwd) through its cached parent directory.
 static EFI_STATUS shell_open_path(Shell *shell, const char *path, UINT64 mode, UINT64 attrs, EFI_FILE_PROTOCOL **out) {
     if (out == NULL) {
         return EFI_INVALID_PARAMETER;
@@ -892,26 +1548,55 @@ static EFI_STATUS shell_open_path(Shell *shell, const char *path, UINT64 mode, U
 
     char resolved[SHELL_PATH_MAX];
     CHAR16 path16[SHELL_PATH_MAX];
-    if (!shell_normalize_path(shell->cwd, path, resolved, sizeof(resolved)) ||
-        !shell_path_to_char16(resolved, path16, SHELL_PATH_MAX)) {
+    if (!shell_normalize_path(shell->cwd, path, resolved, sizeof(resolved))) {
         return EFI_INVALID_PARAMETER;
     }
 
-    EFI_FILE_PROTOCOL *root = NULL;
-    EFI_STATUS status = shell_open_root(shell, &root);
-    if (EFI_ERROR(status) || root == NULL) {
-        return status;
+    // Split into parent directory and leaf name. The root itself is opened
+    // by its absolute path.
+    char parent[SHELL_PATH_MAX];
+    const char *leaf = resolved;
+    UINTN split = 0;
+    for (UINTN i = 0; resolved[i] != '\0'; i++) {
+        if (resolved[i] == '\\') {
+            split = i;
+        }
+    }
+    parent[0] = '\\';
+    parent[1] = '\0';
+    if (resolved[1] != '\0') {
+        for (UINTN i = 1; i < split; i++) {
+            parent[i] = resolved[i];
+        }
+        if (split > 0) {
+            parent[split] = '\0';
+        }
+        leaf = resolved + split + 1;
+    }
+    if (!shell_path_to_char16(leaf, path16, SHELL_PATH_MAX)) {
+        return EFI_INVALID_PARAMETER;
     }
 
-    status = uefi_call_wrapper(root->Open, 5, root, out, path16, mode, attrs);
-    uefi_call_wrapper(root->Close, 1, root);
+    EFI_STATUS status = EFI_SUCCESS;
+    for (UINTN attempt = 0; attempt < 2; attempt++) {
+        EFI_FILE_PROTOCOL *dir = NULL;
+        status = shell_dir_cache_get(shell, parent, &dir);
+        if (!EFI_ERROR(status)) {
+            status = SHELL_FILE_CALL(shell, dir->Open, 5, dir, out, path16, mode, attrs);
+        }
+        if (status != EFI_MEDIA_CHANGED && status != EFI_NO_MEDIA) {
+            break;
+        }
+        // Cached handles belong to the old media; reopen the volume once.
+        shell_dir_cache_flush(shell);
+    }
     return status;
 }
 
 static EFI_FILE_INFO *shell_get_file_info(Shell *shell, EFI_FILE_PROTOCOL *file, EFI_STATUS *out_status) {
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
     UINTN info_size = 0;
-    EFI_STATUS status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, NULL);
+    EFI_STATUS status = SHELL_FILE_CALL(shell, file->GetInfo, 4, file, &file_info_guid, &info_size, NULL);
     if (status != EFI_BUFFER_TOO_SMALL || info_size == 0) {
         if (out_status != NULL) {
             *out_status = status;
@@ -927,7 +1612,7 @@ static EFI_FILE_INFO *shell_get_file_info(Shell *shell, EFI_FILE_PROTOCOL *file,
         return NULL;
     }
 
-    status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, info);
+    status = SHELL_FILE_CALL(shell, file->GetInfo, 4, file, &file_info_guid, &info_size, info);
     if (EFI_ERROR(status)) {
         shell_free(shell, info);
         if (out_status != NULL) {
@@ -1086,14 +1771,25 @@ static void shell_print_file_name(Shell *shell, const CHAR16 *name) {
 
 // `ls [path]` implementation.
 // If path is a file, print that entry; if path is a directory, iterate entries.
-static void shell_cmd_ls(Shell *shell, const char *arg) {
-    EFI_FILE_PROTOCOL *root = NULL;
+static void shell_cmd_ls(Shell *shell, UINTN argc, char **argv) {
     EFI_FILE_PROTOCOL *dir = NULL;
     CHAR16 path16[SHELL_PATH_MAX];
     char resolved[SHELL_PATH_MAX];
-    char path_arg[SHELL_PATH_MAX];
+    const char *path_arg = NULL;
     BOOLEAN long_mode = FALSE;
-    shell_parse_ls_args(arg, &long_mode, path_arg, sizeof(path_arg));
+    for (UINTN i = 1; i < argc; i++) {
+        if (u_strcmp(argv[i], "-l") == 0) {
+            long_mode = TRUE;
+        } else if (path_arg == NULL) {
+            path_arg = argv[i];
+        } else {
+            shell_println(shell, "ls: usage: ls [-l] [path]");
+            return;
+        }
+    }
+    if (path_arg == NULL) {
+        path_arg = ".";
+    }
 
     if (!shell_normalize_path(shell->cwd, path_arg, resolved, sizeof(resolved)) ||
         !shell_path_to_char16(resolved, path16, SHELL_PATH_MAX)) {
@@ -1101,14 +1797,7 @@ static void shell_cmd_ls(Shell *shell, const char *arg) {
         return;
     }
 
-    EFI_STATUS status = shell_open_root(shell, &root);
-    if (EFI_ERROR(status) || root == NULL) {
-        shell_print_error_status(shell, "ls filesystem open failed", status);
-        return;
-    }
-
-    status = uefi_call_wrapper(root->Open, 5, root, &dir, path16, EFI_FILE_MODE_READ, 0);
-    uefi_call_wrapper(root->Close, 1, root);
+    EFI_STATUS status = shell_open_path(shell, resolved, EFI_FILE_MODE_READ, 0, &dir);
     if (EFI_ERROR(status) || dir == NULL) {
         shell_print_error_status(shell, "ls open path failed", status);
         return;
@@ -1116,11 +1805,11 @@ static void shell_cmd_ls(Shell *shell, const char *arg) {
 
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
     UINTN meta_size = 0;
-    status = uefi_call_wrapper(dir->GetInfo, 4, dir, &file_info_guid, &meta_size, NULL);
+    status = SHELL_FILE_CALL(shell, dir->GetInfo, 4, dir, &file_info_guid, &meta_size, NULL);
     if (status == EFI_BUFFER_TOO_SMALL && meta_size > 0) {
         EFI_FILE_INFO *meta = (EFI_FILE_INFO *)shell_alloc(shell, meta_size);
         if (meta != NULL) {
-            status = uefi_call_wrapper(dir->GetInfo, 4, dir, &file_info_guid, &meta_size, meta);
+            status = SHELL_FILE_CALL(shell, dir->GetInfo, 4, dir, &file_info_guid, &meta_size, meta);
             if (!EFI_ERROR(status) && (meta->Attribute & EFI_FILE_DIRECTORY) == 0) {
                 if (long_mode) {
                     char size_buf[32];
@@ -1147,7 +1836,7 @@ static void shell_cmd_ls(Shell *shell, const char *arg) {
                 }
                 shell_print_file_name(shell, meta->FileName);
                 shell_free(shell, meta);
-                uefi_call_wrapper(dir->Close, 1, dir);
+                shell_file_close(shell, dir);
                 return;
             }
             shell_free(shell, meta);
@@ -1158,14 +1847,14 @@ static void shell_cmd_ls(Shell *shell, const char *arg) {
     EFI_FILE_INFO *info = (EFI_FILE_INFO *)shell_alloc(shell, info_buf_size);
     if (info == NULL) {
         shell_println(shell, "ls: out of memory");
-        uefi_call_wrapper(dir->Close, 1, dir);
+        shell_file_close(shell, dir);
         return;
     }
 
-    uefi_call_wrapper(dir->SetPosition, 2, dir, 0);
+    SHELL_FILE_CALL(shell, dir->SetPosition, 2, dir, 0);
     while (1) {
         UINTN read_size = info_buf_size;
-        status = uefi_call_wrapper(dir->Read, 3, dir, &read_size, info);
+        status = shell_file_read(shell, dir, &read_size, info);
         if (status == EFI_BUFFER_TOO_SMALL && read_size > info_buf_size) {
             // Some filesystems return variable-sized file info records.
             shell_free(shell, info);
@@ -1214,20 +1903,22 @@ static void shell_cmd_ls(Shell *shell, const char *arg) {
     }
 
     shell_free(shell, info);
-    uefi_call_wrapper(dir->Close, 1, dir);
+    shell_file_close(shell, dir);
 }
 
 // `cat <path>` implementation (text-oriented viewer).
-static void shell_cmd_cat(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        shell_println(shell, "cat: usage: cat <path>");
+static void shell_cmd_cat(Shell *shell, UINTN argc, char **argv) {
+    EFI_FILE_PROTOCOL *file = NULL;
+    if (argc == 1) {
+        if (shell->in == NULL) {
+            shell_println(shell, "cat: usage: cat <path>");
+            return;
+        }
+        shell_cat_stream(shell, file);
         return;
     }
 
-    EFI_FILE_PROTOCOL *root = NULL;
-    EFI_FILE_PROTOCOL *file = NULL;
+    const char *raw = argv[1];
     CHAR16 path16[SHELL_PATH_MAX];
     char resolved[SHELL_PATH_MAX];
 
@@ -1237,14 +1928,7 @@ static void shell_cmd_cat(Shell *shell, const char *arg) {
         return;
     }
 
-    EFI_STATUS status = shell_open_root(shell, &root);
-    if (EFI_ERROR(status) || root == NULL) {
-        shell_print_error_status(shell, "cat filesystem open failed", status);
-        return;
-    }
-
-    status = uefi_call_wrapper(root->Open, 5, root, &file, path16, EFI_FILE_MODE_READ, 0);
-    uefi_call_wrapper(root->Close, 1, root);
+    EFI_STATUS status = shell_open_path(shell, resolved, EFI_FILE_MODE_READ, 0, &file);
     if (EFI_ERROR(status) || file == NULL) {
         shell_print_error_status(shell, "cat open failed", status);
         return;
@@ -1252,62 +1936,64 @@ static void shell_cmd_cat(Shell *shell, const char *arg) {
 
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
     UINTN info_size = 0;
-    status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, NULL);
+    status = SHELL_FILE_CALL(shell, file->GetInfo, 4, file, &file_info_guid, &info_size, NULL);
     if (status == EFI_BUFFER_TOO_SMALL && info_size > 0) {
         EFI_FILE_INFO *info = (EFI_FILE_INFO *)shell_alloc(shell, info_size);
         if (info != NULL) {
-            status = uefi_call_wrapper(file->GetInfo, 4, file, &file_info_guid, &info_size, info);
+            status = SHELL_FILE_CALL(shell, file->GetInfo, 4, file, &file_info_guid, &info_size, info);
             if (!EFI_ERROR(status) && (info->Attribute & EFI_FILE_DIRECTORY) != 0) {
                 shell_println(shell, "cat: path is a directory");
                 shell_free(shell, info);
-                uefi_call_wrapper(file->Close, 1, file);
+                shell_file_close(shell, file);
                 return;
             }
             shell_free(shell, info);
         }
     }
 
-    UINT8 *buf = (UINT8 *)shell_alloc(shell, FILE_IO_CHUNK);
+    shell_cat_stream(shell, file);
+    shell_file_close(shell, file);
+}
+
+// Copy `file` (or the piped input when file is NULL) to the output, with
+// non-printable bytes shown as '.'. Runs of printable text are written with
+// one shell_print each instead of per character.
+static void shell_cat_stream(Shell *shell, EFI_FILE_PROTOCOL *file) {
+    UINT8 *buf = (UINT8 *)shell_alloc(shell, FILE_IO_CHUNK + 1);
     if (buf == NULL) {
         shell_println(shell, "cat: out of memory");
-        uefi_call_wrapper(file->Close, 1, file);
         return;
     }
 
     while (1) {
         UINTN read_size = FILE_IO_CHUNK;
-        status = uefi_call_wrapper(file->Read, 3, file, &read_size, buf);
+        EFI_STATUS status = shell_input_read(shell, file, &read_size, buf);
         if (EFI_ERROR(status) || read_size == 0) {
             break;
         }
 
+        // Filter in place: drop '\r', keep display stable for other
+        // non-printable bytes.
+        UINTN n = 0;
         for (UINTN i = 0; i < read_size; i++) {
             char c = (char)buf[i];
             if (c == '\r') {
                 continue;
             }
-            // Keep display stable for non-printable bytes.
-            if (c == '\n' || c == '\t' || (c >= 32 && c <= 126)) {
-                shell_putc(shell, c);
-            } else {
-                shell_putc(shell, '.');
-            }
+            buf[n++] = (c == '\n' || c == '\t' || (c >= 32 && c <= 126)) ? (UINT8)c : (UINT8)'.';
         }
+        buf[n] = '\0';
+        shell_print(shell, (const char *)buf);
     }
 
     shell_putc(shell, '\n');
     shell_free(shell, buf);
-    uefi_call_wrapper(file->Close, 1, file);
 }
 
 // `cd <path>` implementation.
-static void shell_cmd_cd(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        shell_println(shell, "cd: usage: cd <path>");
-        return;
-    }
+static void shell_cmd_cd(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *raw = argv[1];
 
     char resolved[SHELL_PATH_MAX];
     CHAR16 path16[SHELL_PATH_MAX];
@@ -1317,16 +2003,8 @@ static void shell_cmd_cd(Shell *shell, const char *arg) {
         return;
     }
 
-    EFI_FILE_PROTOCOL *root = NULL;
     EFI_FILE_PROTOCOL *node = NULL;
-    EFI_STATUS status = shell_open_root(shell, &root);
-    if (EFI_ERROR(status) || root == NULL) {
-        shell_print_error_status(shell, "cd filesystem open failed", status);
-        return;
-    }
-
-    status = uefi_call_wrapper(root->Open, 5, root, &node, path16, EFI_FILE_MODE_READ, 0);
-    uefi_call_wrapper(root->Close, 1, root);
+    EFI_STATUS status = shell_open_path(shell, resolved, EFI_FILE_MODE_READ, 0, &node);
     if (EFI_ERROR(status) || node == NULL) {
         shell_print_error_status(shell, "cd open failed", status);
         return;
@@ -1334,32 +2012,32 @@ static void shell_cmd_cd(Shell *shell, const char *arg) {
 
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
     UINTN info_size = 0;
-    status = uefi_call_wrapper(node->GetInfo, 4, node, &file_info_guid, &info_size, NULL);
+    status = SHELL_FILE_CALL(shell, node->GetInfo, 4, node, &file_info_guid, &info_size, NULL);
     if (status != EFI_BUFFER_TOO_SMALL || info_size == 0) {
         shell_println(shell, "cd: cannot query path");
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
 
     EFI_FILE_INFO *info = (EFI_FILE_INFO *)shell_alloc(shell, info_size);
     if (info == NULL) {
         shell_println(shell, "cd: out of memory");
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
 
-    status = uefi_call_wrapper(node->GetInfo, 4, node, &file_info_guid, &info_size, info);
+    status = SHELL_FILE_CALL(shell, node->GetInfo, 4, node, &file_info_guid, &info_size, info);
     if (EFI_ERROR(status)) {
         shell_println(shell, "cd: cannot query path");
         shell_free(shell, info);
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
 
     if ((info->Attribute & EFI_FILE_DIRECTORY) == 0) {
         shell_println(shell, "cd: target is not a directory");
         shell_free(shell, info);
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
 
@@ -1371,11 +2049,13 @@ static void shell_cmd_cd(Shell *shell, const char *arg) {
     shell->cwd[i] = '\0';
 
     shell_free(shell, info);
-    uefi_call_wrapper(node->Close, 1, node);
+    shell_file_close(shell, node);
 }
 
 // `pwd` implementation.
-static void shell_cmd_pwd(Shell *shell) {
+static void shell_cmd_pwd(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
     if (shell->cwd[0] == '\\' && shell->cwd[1] == '\0') {
         shell_println(shell, "/");
         return;
@@ -1422,28 +2102,14 @@ static void shell_history_add(Shell *shell, const char *line) {
     shell->history[idx][i] = '\0';
 }
 
-static void shell_cmd_mkdir(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
+static void shell_cmd_mkdir(Shell *shell, UINTN argc, char **argv) {
+    const char *raw = argv[argc - 1];
+    BOOLEAN parents = (argc == 3 && u_strcmp(argv[1], "-p") == 0);
+    if ((argc == 3 && !parents) || u_strcmp(raw, "-p") == 0) {
         shell_println(shell, "mkdir: usage: mkdir [-p] <path>");
         return;
     }
 
-    BOOLEAN parents = FALSE;
-    if (u_strcmp(raw, "-p") == 0) {
-        shell_println(shell, "mkdir: usage: mkdir [-p] <path>");
-        return;
-    }
-    if (u_startswith(raw, "-p ")) {
-        parents = TRUE;
-        raw = u_trim_left((char *)(raw + 2));
-        if (*raw == '\0') {
-            shell_println(shell, "mkdir: usage: mkdir [-p] <path>");
-            return;
-        }
-    }
-
     if (parents) {
         EFI_STATUS st = shell_ensure_dir_tree(shell, raw);
         if (EFI_ERROR(st)) {
@@ -1469,7 +2135,7 @@ static void shell_cmd_mkdir(Shell *shell, const char *arg) {
     EFI_FILE_INFO *info = shell_get_file_info(shell, dir, &info_status);
     if (info == NULL) {
         shell_print_error_status(shell, "mkdir info failed", info_status);
-        uefi_call_wrapper(dir->Close, 1, dir);
+        shell_file_close(shell, dir);
         return;
     }
 
@@ -1478,16 +2144,12 @@ static void shell_cmd_mkdir(Shell *shell, const char *arg) {
     }
 
     shell_free(shell, info);
-    uefi_call_wrapper(dir->Close, 1, dir);
+    shell_file_close(shell, dir);
 }
 
-static void shell_cmd_touch(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        shell_println(shell, "touch: usage: touch <path>");
-        return;
-    }
+static void shell_cmd_touch(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *raw = argv[1];
 
     EFI_FILE_PROTOCOL *file = NULL;
     EFI_STATUS status = shell_open_path(
@@ -1506,7 +2168,7 @@ static void shell_cmd_touch(Shell *shell, const char *arg) {
     EFI_FILE_INFO *info = shell_get_file_info(shell, file, &info_status);
     if (info == NULL) {
         shell_print_error_status(shell, "touch info failed", info_status);
-        uefi_call_wrapper(file->Close, 1, file);
+        shell_file_close(shell, file);
         return;
     }
 
@@ -1515,7 +2177,7 @@ static void shell_cmd_touch(Shell *shell, const char *arg) {
     }
 
     shell_free(shell, info);
-    uefi_call_wrapper(file->Close, 1, file);
+    shell_file_close(shell, file);
 }
 
 static EFI_STATUS shell_copy_file(Shell *shell, const char *src_raw, const char *dst_raw) {
@@ -1568,13 +2230,13 @@ static EFI_STATUS shell_copy_file(Shell *shell, const char *src_raw, const char
     EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
     dst_info->FileSize = 0;
     dst_info->PhysicalSize = 0;
-    status = uefi_call_wrapper(dst->SetInfo, 4, dst, &file_info_guid, dst_info->Size, dst_info);
+    status = SHELL_FILE_CALL(shell, dst->SetInfo, 4, dst, &file_info_guid, dst_info->Size, dst_info);
     if (EFI_ERROR(status)) {
         goto out;
     }
 
-    uefi_call_wrapper(src->SetPosition, 2, src, 0);
-    uefi_call_wrapper(dst->SetPosition, 2, dst, 0);
+    SHELL_FILE_CALL(shell, src->SetPosition, 2, src, 0);
+    SHELL_FILE_CALL(shell, dst->SetPosition, 2, dst, 0);
 
     buf = (UINT8 *)shell_alloc(shell, FILE_IO_CHUNK);
     if (buf == NULL) {
@@ -1584,7 +2246,7 @@ static EFI_STATUS shell_copy_file(Shell *shell, const char *src_raw, const char
 
     while (1) {
         UINTN read_size = FILE_IO_CHUNK;
-        status = uefi_call_wrapper(src->Read, 3, src, &read_size, buf);
+        status = shell_file_read(shell, src, &read_size, buf);
         if (EFI_ERROR(status)) {
             goto out;
         }
@@ -1593,7 +2255,7 @@ static EFI_STATUS shell_copy_file(Shell *shell, const char *src_raw, const char
         }
 
         UINTN write_size = read_size;
-        status = uefi_call_wrapper(dst->Write, 3, dst, &write_size, buf);
+        status = shell_file_write(shell, dst, &write_size, buf);
         if (EFI_ERROR(status) || write_size != read_size) {
             status = EFI_ERROR(status) ? status : EFI_DEVICE_ERROR;
             goto out;
@@ -1612,23 +2274,18 @@ out:
         shell_free(shell, buf);
     }
     if (src != NULL) {
-        uefi_call_wrapper(src->Close, 1, src);
+        shell_file_close(shell, src);
     }
     if (dst != NULL) {
-        uefi_call_wrapper(dst->Close, 1, dst);
+        shell_file_close(shell, dst);
     }
     return status;
 }
 
-static void shell_cmd_cp(Shell *shell, const char *src_arg, const char *dst_arg) {
-    const char *src_raw = (src_arg != NULL) ? src_arg : "";
-    const char *dst_raw = (dst_arg != NULL) ? dst_arg : "";
-    src_raw = u_trim_left((char *)src_raw);
-    dst_raw = u_trim_left((char *)dst_raw);
-    if (*src_raw == '\0' || *dst_raw == '\0') {
-        shell_println(shell, "cp: usage: cp <src> <dst>");
-        return;
-    }
+static void shell_cmd_cp(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *src_raw = argv[1];
+    const char *dst_raw = argv[2];
 
     EFI_STATUS st = shell_copy_file(shell, src_raw, dst_raw);
     if (EFI_ERROR(st)) {
@@ -1636,13 +2293,9 @@ static void shell_cmd_cp(Shell *shell, const char *src_arg, const char *dst_arg)
     }
 }
 
-static void shell_cmd_rm(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        shell_println(shell, "rm: usage: rm <path>");
-        return;
-    }
+static void shell_cmd_rm(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *raw = argv[1];
 
     EFI_FILE_PROTOCOL *node = NULL;
     EFI_STATUS status = shell_open_path(shell, raw, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0, &node);
@@ -1655,32 +2308,27 @@ static void shell_cmd_rm(Shell *shell, const char *arg) {
     EFI_FILE_INFO *info = shell_get_file_info(shell, node, &info_status);
     if (info == NULL) {
         shell_print_error_status(shell, "rm info failed", info_status);
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
     if ((info->Attribute & EFI_FILE_DIRECTORY) != 0) {
         shell_println(shell, "rm: refusing to remove a directory");
         shell_free(shell, info);
-        uefi_call_wrapper(node->Close, 1, node);
+        shell_file_close(shell, node);
         return;
     }
     shell_free(shell, info);
 
-    status = uefi_call_wrapper(node->Delete, 1, node);
+    status = SHELL_FILE_CALL(shell, node->Delete, 1, node);
     if (EFI_ERROR(status)) {
         shell_print_error_status(shell, "rm delete failed", status);
     }
 }
 
-static void shell_cmd_mv(Shell *shell, const char *src_arg, const char *dst_arg) {
-    const char *src_raw = (src_arg != NULL) ? src_arg : "";
-    const char *dst_raw = (dst_arg != NULL) ? dst_arg : "";
-    src_raw = u_trim_left((char *)src_raw);
-    dst_raw = u_trim_left((char *)dst_raw);
-    if (*src_raw == '\0' || *dst_raw == '\0') {
-        shell_println(shell, "mv: usage: mv <src> <dst>");
-        return;
-    }
+static void shell_cmd_mv(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *src_raw = argv[1];
+    const char *dst_raw = argv[2];
 
     EFI_STATUS st = shell_copy_file(shell, src_raw, dst_raw);
     if (EFI_ERROR(st)) {
@@ -1694,34 +2342,34 @@ static void shell_cmd_mv(Shell *shell, const char *src_arg, const char *dst_arg)
         shell_print_error_status(shell, "mv cleanup open failed", st);
         return;
     }
-    st = uefi_call_wrapper(node->Delete, 1, node);
+    st = SHELL_FILE_CALL(shell, node->Delete, 1, node);
     if (EFI_ERROR(st)) {
         shell_print_error_status(shell, "mv cleanup delete failed", st);
     }
 }
 
-static void shell_cmd_hexdump(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
+static void shell_cmd_hexdump(Shell *shell, UINTN argc, char **argv) {
+    EFI_FILE_PROTOCOL *file = NULL;
+    EFI_STATUS status = EFI_SUCCESS;
+    if (argc == 1 && shell->in == NULL) {
         shell_println(shell, "hexdump: usage: hexdump <path>");
         return;
     }
-
-    EFI_FILE_PROTOCOL *file = NULL;
-    EFI_STATUS status = shell_open_path(shell, raw, EFI_FILE_MODE_READ, 0, &file);
-    if (EFI_ERROR(status) || file == NULL) {
-        shell_print_error_status(shell, "hexdump open failed", status);
-        return;
+    if (argc > 1) {
+        status = shell_open_path(shell, argv[1], EFI_FILE_MODE_READ, 0, &file);
+        if (EFI_ERROR(status) || file == NULL) {
+            shell_print_error_status(shell, "hexdump open failed", status);
+            return;
+        }
     }
 
     EFI_STATUS info_status = EFI_SUCCESS;
-    EFI_FILE_INFO *info = shell_get_file_info(shell, file, &info_status);
+    EFI_FILE_INFO *info = (file != NULL) ? shell_get_file_info(shell, file, &info_status) : NULL;
     if (info != NULL) {
         if ((info->Attribute & EFI_FILE_DIRECTORY) != 0) {
             shell_println(shell, "hexdump: path is a directory");
             shell_free(shell, info);
-            uefi_call_wrapper(file->Close, 1, file);
+            shell_file_close(shell, file);
             return;
         }
         shell_free(shell, info);
@@ -1730,14 +2378,16 @@ static void shell_cmd_hexdump(Shell *shell, const char *arg) {
     UINT8 *buf = (UINT8 *)shell_alloc(shell, FILE_IO_CHUNK);
     if (buf == NULL) {
         shell_println(shell, "hexdump: out of memory");
-        uefi_call_wrapper(file->Close, 1, file);
+        if (file != NULL) {
+            shell_file_close(shell, file);
+        }
         return;
     }
 
     UINT64 offset = 0;
     while (1) {
         UINTN read_size = FILE_IO_CHUNK;
-        status = uefi_call_wrapper(file->Read, 3, file, &read_size, buf);
+        status = shell_input_read(shell, file, &read_size, buf);
         if (EFI_ERROR(status) || read_size == 0) {
             break;
         }
@@ -1773,20 +2423,31 @@ static void shell_cmd_hexdump(Shell *shell, const char *arg) {
     }
 
     shell_free(shell, buf);
-    uefi_call_wrapper(file->Close, 1, file);
+    if (file != NULL) {
+        shell_file_close(shell, file);
+    }
 }
 
-static void shell_cmd_history(Shell *shell) {
+static void shell_cmd_history(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
     shell_print_history(shell);
 }
 
-static void shell_cmd_viewbmp(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
-    if (*raw == '\0') {
-        shell_println(shell, "viewbmp: usage: viewbmp <path>");
-        return;
+// Bring shell text back after a full-screen image. Without a cell model
+// the old text is gone, so the screen is just cleared.
+static void shell_restore_screen(Shell *shell) {
+    if (shell->cell_chars != NULL) {
+        gfx_clear(shell->gfx, shell->bg_color);
+        shell_repaint(shell);
+    } else {
+        shell_clear(shell);
     }
+}
+
+static void shell_cmd_viewbmp(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    const char *raw = argv[1];
 
     EFI_FILE_PROTOCOL *file = NULL;
     EFI_STATUS status = shell_open_path(shell, raw, EFI_FILE_MODE_READ, 0, &file);
@@ -1795,50 +2456,26 @@ static void shell_cmd_viewbmp(Shell *shell, const char *arg) {
         return;
     }
 
-    EFI_STATUS info_status = EFI_SUCCESS;
-    EFI_FILE_INFO *info = shell_get_file_info(shell, file, &info_status);
-    if (info == NULL) {
-        shell_print_error_status(shell, "viewbmp info failed", info_status);
-        uefi_call_wrapper(file->Close, 1, file);
-        return;
-    }
-    if ((info->Attribute & EFI_FILE_DIRECTORY) != 0 || info->FileSize == 0 || info->FileSize > 32U * 1024U * 1024U) {
-        shell_println(shell, "viewbmp: invalid file");
-        shell_free(shell, info);
-        uefi_call_wrapper(file->Close, 1, file);
-        return;
-    }
-
-    UINTN size = (UINTN)info->FileSize;
-    shell_free(shell, info);
-    UINT8 *data = (UINT8 *)shell_alloc(shell, size);
-    if (data == NULL) {
-        shell_println(shell, "viewbmp: out of memory");
-        uefi_call_wrapper(file->Close, 1, file);
+    ImageIo io = { shell, shell_image_read, shell_image_set_position, shell_image_get_position, shell_image_alloc, shell_image_free };
+    status = image_draw_file(shell->st, shell->gfx, file, &io);
+    shell_file_close(shell, file);
+    if (status == EFI_UNSUPPORTED) {
+        shell_println(shell, "viewbmp: unsupported image (need QOI or uncompressed 24/32-bit BMP)");
         return;
     }
-
-    UINTN read_size = size;
-    status = uefi_call_wrapper(file->Read, 3, file, &read_size, data);
-    uefi_call_wrapper(file->Close, 1, file);
-    if (EFI_ERROR(status) || read_size != size) {
+    if (EFI_ERROR(status)) {
+        // A failed read can leave part of the image on screen.
+        shell_restore_screen(shell);
         shell_print_error_status(shell, "viewbmp read failed", status);
-        shell_free(shell, data);
-        return;
-    }
-
-    if (!shell_draw_bmp_centered(shell, data, size)) {
-        shell_println(shell, "viewbmp: unsupported BMP (need uncompressed 24/32-bit)");
-        shell_free(shell, data);
         return;
     }
-    shell_free(shell, data);
 
     const char *hint = "Press any key to return...";
     UINTN hint_w = font_text_width(hint, 2);
     UINTN hint_x = (shell->gfx->width > hint_w) ? (shell->gfx->width - hint_w) / 2 : 8;
     UINTN hint_y = shell->gfx->height - 48;
     font_draw_text(shell->gfx, hint_x, hint_y, hint, 0xF0F0F0, 0x000000, 2, TRUE);
+    gfx_present(shell->gfx);
 
     if (shell->st != NULL && shell->st->BootServices != NULL && shell->st->ConIn != NULL) {
         UINTN idx;
@@ -1848,10 +2485,12 @@ static void shell_cmd_viewbmp(Shell *shell, const char *arg) {
         uefi_call_wrapper(shell->st->ConIn->ReadKeyStroke, 2, shell->st->ConIn, &key);
     }
 
-    shell_clear(shell);
+    shell_restore_screen(shell);
 }
 
-static void shell_cmd_initfs(Shell *shell) {
+static void shell_cmd_initfs(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
     static const char *paths[] = {
         "\\HATTEROS",
         "\\HATTEROS\\system",
@@ -1878,11 +2517,10 @@ static void shell_cmd_initfs(Shell *shell) {
     shell_println(shell, "initfs: /HATTEROS directory tree ready");
 }
 
-static void shell_cmd_theme(Shell *shell, const char *arg) {
-    const char *raw = (arg != NULL) ? arg : "";
-    raw = u_trim_left((char *)raw);
+static void shell_cmd_theme(Shell *shell, UINTN argc, char **argv) {
+    const char *raw = (argc > 1) ? argv[1] : "";
 
-    if (*raw == '\0') {
+    if (argc == 1) {
         shell_println(shell, "theme usage:");
         shell_println(shell, "  theme default");
         shell_println(shell, "  theme light");
@@ -1894,6 +2532,11 @@ static void shell_cmd_theme(Shell *shell, const char *arg) {
         return;
     }
 
+    if (argc == 3 && u_strcmp(raw, "prompt") != 0) {
+        shell_println(shell, "theme: unknown option");
+        return;
+    }
+
     if (u_strcmp(raw, "default") == 0) {
         shell_apply_theme(shell, 0xE8E8E8, 0x10161E, TRUE);
         shell_save_settings(shell);
@@ -1915,8 +2558,8 @@ static void shell_cmd_theme(Shell *shell, const char *arg) {
         return;
     }
 
-    if (u_startswith(raw, "prompt ")) {
-        const char *mode = u_trim_left((char *)(raw + 7));
+    if (u_strcmp(raw, "prompt") == 0) {
+        const char *mode = (argc == 3) ? argv[2] : "";
         if (u_strcmp(mode, "full") == 0) {
             shell->prompt_show_path = TRUE;
             shell_save_settings(shell);
@@ -1936,7 +2579,9 @@ static void shell_cmd_theme(Shell *shell, const char *arg) {
     shell_println(shell, "theme: unknown option");
 }
 
-static void shell_cmd_time(Shell *shell) {
+static void shell_cmd_time(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
     if (shell == NULL || shell->st == NULL || shell->st->RuntimeServices == NULL) {
         shell_println(shell, "time: runtime services unavailable");
         return;
@@ -1964,7 +2609,9 @@ static void shell_cmd_time(Shell *shell) {
     shell_putc(shell, '\n');
 }
 
-static void shell_cmd_memmap(Shell *shell) {
+static void shell_cmd_memmap(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
     if (shell == NULL || shell->st == NULL || shell->st->BootServices == NULL) {
         shell_println(shell, "memmap: boot services unavailable");
         return;
@@ -2062,241 +2709,1370 @@ static void shell_cmd_memmap(Shell *shell) {
     shell_free(shell, map);
 }
 
-// Print runtime/system metadata for debugging.
-static void print_info(Shell *shell) {
-    char w[32], h[32], fb_addr[32], fb_size[32];
-    u_u64_to_dec(shell->gfx->width, w, sizeof(w));
-    u_u64_to_dec(shell->gfx->height, h, sizeof(h));
-    u_u64_to_hex((UINT64)shell->gfx->framebuffer_base, fb_addr, sizeof(fb_addr));
-    u_u64_to_dec(shell->gfx->framebuffer_size, fb_size, sizeof(fb_size));
-
-    shell_println(shell, "HatterOS stage-0 shell");
-    shell_print(shell, "Version: ");
-    shell_println(shell, HATTEROS_VERSION);
-    shell_print(shell, "Build: ");
-    shell_println(shell, HATTEROS_BUILD_DATE);
-    shell_print(shell, "Resolution: ");
-    shell_print(shell, w);
-    shell_print(shell, "x");
-    shell_println(shell, h);
-    shell_print(shell, "Framebuffer: ");
-    shell_println(shell, fb_addr);
-    shell_print(shell, "Framebuffer size: ");
-    shell_print(shell, fb_size);
-    shell_println(shell, " bytes");
+// Append `text` to `out` at *pos, truncating at out_len - 1.
+static void shell_append(char *out, UINTN out_len, UINTN *pos, const char *text) {
+    while (*text != '\0' && *pos + 1 < out_len) {
+        out[(*pos)++] = *text++;
+    }
+    out[*pos] = '\0';
 }
 
-// Parse and dispatch one command line.
-static void shell_execute(Shell *shell, char *line) {
-    char *cmd = u_trim_left(line);
-    if (*cmd == '\0') {
-        return;
+// Append `value` in decimal, zero-padded to `width` digits.
+static void shell_append_u64(char *out, UINTN out_len, UINTN *pos, UINT64 value, UINTN width) {
+    char buf[32];
+    u_u64_to_dec(value, buf, sizeof(buf));
+    for (UINTN len = u_strlen(buf); len < width; len++) {
+        shell_append(out, out_len, pos, "0");
     }
+    shell_append(out, out_len, pos, buf);
+}
 
-    if (u_strcmp(cmd, "help") == 0) {
-        shell_print_help(shell, "");
+// Append the current UEFI time as "YYYY-MM-DD hh:mm:ss"; appends nothing
+// when the clock cannot be read.
+static void shell_append_timestamp(Shell *shell, char *out, UINTN out_len, UINTN *pos) {
+    EFI_TIME now;
+    if (shell->st->RuntimeServices == NULL ||
+        EFI_ERROR(uefi_call_wrapper(shell->st->RuntimeServices->GetTime, 2, &now, NULL))) {
         return;
     }
+    shell_append_u64(out, out_len, pos, now.Year, 4);
+    shell_append(out, out_len, pos, "-");
+    shell_append_u64(out, out_len, pos, now.Month, 2);
+    shell_append(out, out_len, pos, "-");
+    shell_append_u64(out, out_len, pos, now.Day, 2);
+    shell_append(out, out_len, pos, " ");
+    shell_append_u64(out, out_len, pos, now.Hour, 2);
+    shell_append(out, out_len, pos, ":");
+    shell_append_u64(out, out_len, pos, now.Minute, 2);
+    shell_append(out, out_len, pos, ":");
+    shell_append_u64(out, out_len, pos, now.Second, 2);
+}
 
-    if (u_startswith(cmd, "help ")) {
-        shell_print_help(shell, u_trim_left(cmd + 5));
-        return;
+// Open (creating as needed) a log file under SHELL_LOG_DIR, positioned at end
+// of file. *is_new is set when the file is empty so the caller can write a
+// CSV header first. Returns NULL on any failure.
+static EFI_FILE_PROTOCOL *shell_open_log(Shell *shell, const char *path, BOOLEAN *is_new) {
+    if (EFI_ERROR(shell_ensure_dir_tree(shell, SHELL_LOG_DIR))) {
+        return NULL;
     }
 
-    if (u_strcmp(cmd, "clear") == 0) {
-        shell_clear(shell);
-        return;
+    EFI_FILE_PROTOCOL *log = NULL;
+    EFI_STATUS status = shell_open_path(
+        shell,
+        path,
+        EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+        0,
+        &log
+    );
+    if (EFI_ERROR(status) || log == NULL) {
+        return NULL;
     }
 
-    if (u_strcmp(cmd, "info") == 0) {
-        print_info(shell);
-        return;
-    }
+    // Seeking to the all-ones position moves to end of file.
+    UINT64 size = 0;
+    SHELL_FILE_CALL(shell, log->SetPosition, 2, log, 0xFFFFFFFFFFFFFFFFULL);
+    SHELL_FILE_CALL(shell, log->GetPosition, 2, log, &size);
+    *is_new = (size == 0);
+    return log;
+}
 
-    if (u_strcmp(cmd, "reboot") == 0) {
-        shell_println(shell, "Rebooting...");
-        uefi_call_wrapper(shell->st->RuntimeServices->ResetSystem, 4, EfiResetWarm, EFI_SUCCESS, 0, NULL);
+// `bootstat`: time spent in each efi_main phase of this boot.
+static void shell_cmd_bootstat(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    if (hz == 0) {
+        shell_println(shell, "bootstat: TSC frequency unknown");
         return;
     }
 
-    if (u_strcmp(cmd, "echo") == 0) {
-        shell_putc(shell, '\n');
-        return;
-    }
+    shell_print(shell, "TSC: ");
+    shell_print_u64(shell, hz / 1000000);
+    shell_println(shell, " MHz");
 
-    if (u_startswith(cmd, "echo ")) {
-        shell_println(shell, cmd + 5);
-        return;
+    for (UINTN phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+        const char *name = boot_phase_name((BootPhase)phase);
+        shell_print(shell, "  ");
+        shell_print(shell, name);
+        for (UINTN len = u_strlen(name); len < 16; len++) {
+            shell_putc(shell, ' ');
+        }
+        shell_print_u64(shell, boot_cycles_to_us(boot_phase_cycles((BootPhase)phase), hz));
+        shell_println(shell, " us");
     }
 
-    if (u_strcmp(cmd, "pwd") == 0) {
-        shell_cmd_pwd(shell);
-        return;
+    UINT64 entry = boot_stamp(BOOT_PHASE_ENTRY);
+    UINT64 prompt = boot_stamp(BOOT_PHASE_PROMPT);
+    if (prompt > entry) {
+        shell_print(shell, "efi_main to prompt: ");
+        shell_print_u64(shell, boot_cycles_to_us(prompt - entry, hz) / 1000);
+        shell_println(shell, " ms");
+        shell_print(shell, "reset to prompt:    ");
+        shell_print_u64(shell, boot_cycles_to_us(prompt, hz) / 1000);
+        shell_println(shell, " ms");
     }
+    shell_println(shell, "History: /HATTEROS/system/log/boot.csv");
+}
 
-    if (u_startswith(cmd, "cd ")) {
-        shell_cmd_cd(shell, u_trim_left(cmd + 3));
+// Append event records not yet on disk to SHELL_EVENT_LOG_PATH. Without
+// `force` this only happens once an error is pending or a batch has built
+// up, so a quiet session costs nothing at the prompt. Records overwritten
+// in the ring before reaching disk are replaced by one "dropped" record.
+static void shell_flush_events(Shell *shell, BOOLEAN force) {
+    UINT64 seq = evlog_flushed_seq();
+    UINT64 end = evlog_next_seq();
+    if (seq == end || (!force && shell->event_log_failed)) {
         return;
     }
-
-    if (u_strcmp(cmd, "cd") == 0) {
-        shell_cmd_cd(shell, "");
+    if (!force && !evlog_error_pending() && end - seq < SHELL_EVENT_FLUSH_BATCH) {
         return;
     }
 
-    if (u_strcmp(cmd, "ls") == 0) {
-        shell_cmd_ls(shell, "");
-        return;
-    }
+    // Marked before writing: errors from the writes below are new records
+    // and must not make every prompt retry.
+    evlog_mark_flushed(end);
 
-    if (u_startswith(cmd, "ls ")) {
-        shell_cmd_ls(shell, u_trim_left(cmd + 3));
+    BOOLEAN is_new = FALSE;
+    EFI_FILE_PROTOCOL *log = shell_open_log(shell, SHELL_EVENT_LOG_PATH, &is_new);
+    if (log == NULL) {
+        shell->event_log_failed = TRUE;
         return;
     }
 
-    if (u_startswith(cmd, "cat ")) {
-        shell_cmd_cat(shell, u_trim_left(cmd + 4));
-        return;
+    EFI_STATUS status = EFI_SUCCESS;
+    if (is_new) {
+        EvlogFileHeader header = {0};
+        header.magic = EVLOG_FILE_MAGIC;
+        header.version = EVLOG_FILE_VERSION;
+        header.record_size = sizeof(EvlogRecord);
+        UINTN size = sizeof(header);
+        status = shell_file_write(shell, log, &size, &header);
+    }
+
+    if (!EFI_ERROR(status) && end - seq > EVLOG_RING_RECORDS) {
+        EvlogRecord dropped = {0};
+        dropped.tsc = cpu_rdtsc();
+        dropped.arg0 = end - seq - EVLOG_RING_RECORDS;
+        dropped.seq = (UINT32)seq;
+        dropped.subsystem = EVLOG_SYS_LOG;
+        dropped.event = EVLOG_LOG_DROPPED;
+        UINTN size = sizeof(dropped);
+        status = shell_file_write(shell, log, &size, &dropped);
+        seq = end - EVLOG_RING_RECORDS;
+    }
+
+    // At most two writes: the ring may wrap once between seq and end.
+    while (!EFI_ERROR(status) && seq < end) {
+        UINTN count = (UINTN)(end - seq);
+        UINTN to_wrap = EVLOG_RING_RECORDS - (UINTN)(seq % EVLOG_RING_RECORDS);
+        if (count > to_wrap) {
+            count = to_wrap;
+        }
+        UINTN size = count * sizeof(EvlogRecord);
+        status = shell_file_write(shell, log, &size, (void *)evlog_record(seq));
+        seq += count;
     }
 
-    if (u_strcmp(cmd, "cat") == 0) {
-        shell_cmd_cat(shell, "");
-        return;
+    shell_file_close(shell, log);
+    if (EFI_ERROR(status)) {
+        shell->event_log_failed = TRUE;
     }
+}
 
-    if (u_startswith(cmd, "mkdir ")) {
-        shell_cmd_mkdir(shell, u_trim_left(cmd + 6));
-        return;
-    }
+// One decoded record: "<seconds since reset> <subsystem> <event> <details>".
+static void shell_print_event(Shell *shell, const EvlogRecord *rec, UINT64 hz) {
+    char line[160];
+    UINTN pos = 0;
+    line[0] = '\0';
 
-    if (u_strcmp(cmd, "mkdir") == 0) {
-        shell_cmd_mkdir(shell, "");
-        return;
+    UINT64 us = boot_cycles_to_us(rec->tsc, hz);
+    char secs[24];
+    u_u64_to_dec(us / 1000000, secs, sizeof(secs));
+    for (UINTN len = u_strlen(secs); len < 6; len++) {
+        shell_append(line, sizeof(line), &pos, " ");
+    }
+    shell_append(line, sizeof(line), &pos, secs);
+    shell_append(line, sizeof(line), &pos, ".");
+    shell_append_u64(line, sizeof(line), &pos, us % 1000000, 6);
+
+    const char *columns[2] = {evlog_subsystem_name(rec->subsystem), evlog_event_name(rec->event)};
+    for (UINTN c = 0; c < 2; c++) {
+        shell_append(line, sizeof(line), &pos, " ");
+        shell_append(line, sizeof(line), &pos, columns[c]);
+        for (UINTN len = u_strlen(columns[c]); len < 11; len++) {
+            shell_append(line, sizeof(line), &pos, " ");
+        }
+    }
+    shell_append(line, sizeof(line), &pos, (rec->level == EVLOG_LEVEL_ERROR) ? "! " : "  ");
+
+    char tag[9];
+    evlog_untag(rec->arg1, tag);
+    switch (rec->event) {
+    case EVLOG_LOG_DROPPED:
+        shell_append_u64(line, sizeof(line), &pos, rec->arg0, 0);
+        shell_append(line, sizeof(line), &pos, " records");
+        break;
+    case EVLOG_BOOT_PHASE:
+        shell_append(line, sizeof(line), &pos, boot_phase_name((BootPhase)rec->arg0));
+        shell_append(line, sizeof(line), &pos, " ");
+        shell_append_u64(line, sizeof(line), &pos, boot_cycles_to_us(rec->arg1, hz), 0);
+        shell_append(line, sizeof(line), &pos, " us");
+        break;
+    case EVLOG_SHELL_UNKNOWN:
+        shell_append(line, sizeof(line), &pos, tag);
+        break;
+    case EVLOG_BOOT_GOP_FAILED:
+    case EVLOG_SHELL_ERROR:
+    case EVLOG_FILE_ERROR:
+        if (tag[0] != '\0') {
+            shell_append(line, sizeof(line), &pos, tag);
+            shell_append(line, sizeof(line), &pos, ": ");
+        }
+        shell_append(line, sizeof(line), &pos, shell_status_str((EFI_STATUS)rec->arg0));
+        break;
+    default:
+        shell_append_u64(line, sizeof(line), &pos, rec->arg0, 0);
+        shell_append(line, sizeof(line), &pos, " ");
+        shell_append_u64(line, sizeof(line), &pos, rec->arg1, 0);
+        break;
     }
+    shell_println(shell, line);
+}
 
-    if (u_startswith(cmd, "touch ")) {
-        shell_cmd_touch(shell, u_trim_left(cmd + 6));
-        return;
+static BOOLEAN shell_event_selected(const EvlogRecord *rec, UINT32 subsystems, BOOLEAN errors_only) {
+    if (errors_only && rec->level != EVLOG_LEVEL_ERROR) {
+        return FALSE;
     }
+    return subsystems == 0 || (rec->subsystem < 32 && (subsystems & (1U << rec->subsystem)) != 0);
+}
 
-    if (u_strcmp(cmd, "touch") == 0) {
-        shell_cmd_touch(shell, "");
-        return;
+// `log [-a] [filter...]`: decode the event ring, or with -a the
+// whole event log file.
+static void shell_cmd_log(Shell *shell, UINTN argc, char **argv) {
+    BOOLEAN all = FALSE;
+    BOOLEAN errors_only = FALSE;
+    UINT32 subsystems = 0;
+    for (UINTN i = 1; i < argc; i++) {
+        if (u_strcmp(argv[i], "-a") == 0) {
+            all = TRUE;
+            continue;
+        }
+        if (u_strcmp(argv[i], "errors") == 0) {
+            errors_only = TRUE;
+            continue;
+        }
+        UINTN sys = 0;
+        while (sys < EVLOG_SYS_COUNT && u_strcmp(argv[i], evlog_subsystem_name(sys)) != 0) {
+            sys++;
+        }
+        if (sys == EVLOG_SYS_COUNT) {
+            shell_print(shell, "log: unknown filter ");
+            shell_println(shell, argv[i]);
+            return;
+        }
+        subsystems |= 1U << sys;
     }
 
-    if (u_startswith(cmd, "cp ")) {
-        char *args = u_trim_left(cmd + 3);
-        char *src = args;
-        while (*args != '\0' && *args != ' ' && *args != '\t') {
-            args++;
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    UINTN shown = 0;
+
+    if (!all) {
+        UINT64 end = evlog_next_seq();
+        UINT64 seq = (end > EVLOG_RING_RECORDS) ? end - EVLOG_RING_RECORDS : 0;
+        if (seq > 0) {
+            shell_print(shell, "(");
+            shell_print_u64(shell, seq);
+            shell_println(shell, " older records only in the log file)");
+        }
+        for (; seq < end; seq++) {
+            const EvlogRecord *rec = evlog_record(seq);
+            if (rec != NULL && shell_event_selected(rec, subsystems, errors_only)) {
+                shell_print_event(shell, rec, hz);
+                shown++;
+            }
         }
-        if (*args == '\0') {
-            shell_cmd_cp(shell, "", "");
+    } else {
+        shell_flush_events(shell, TRUE);
+
+        EFI_FILE_PROTOCOL *file = NULL;
+        EFI_STATUS status = shell_open_path(shell, SHELL_EVENT_LOG_PATH, EFI_FILE_MODE_READ, 0, &file);
+        if (EFI_ERROR(status) || file == NULL) {
+            shell_print_error_status(shell, "log open failed", status);
             return;
         }
-        *args++ = '\0';
-        char *dst = u_trim_left(args);
-        if (*dst == '\0') {
-            shell_cmd_cp(shell, "", "");
+
+        EvlogFileHeader header;
+        UINTN size = sizeof(header);
+        status = shell_file_read(shell, file, &size, &header);
+        if (EFI_ERROR(status) || size != sizeof(header) || header.magic != EVLOG_FILE_MAGIC ||
+            header.version != EVLOG_FILE_VERSION || header.record_size != sizeof(EvlogRecord)) {
+            shell_file_close(shell, file);
+            shell_println(shell, "log: events.bin has an unknown format");
             return;
         }
-        shell_cmd_cp(shell, src, dst);
-        return;
+
+        EvlogRecord records[64];
+        while (1) {
+            size = sizeof(records);
+            status = shell_file_read(shell, file, &size, records);
+            if (EFI_ERROR(status) || size < sizeof(EvlogRecord)) {
+                break;
+            }
+            for (UINTN i = 0; i < size / sizeof(EvlogRecord); i++) {
+                if (shell_event_selected(&records[i], subsystems, errors_only)) {
+                    shell_print_event(shell, &records[i], hz);
+                    shown++;
+                }
+            }
+        }
+        shell_file_close(shell, file);
+        if (EFI_ERROR(status)) {
+            shell_print_error_status(shell, "log read failed", status);
+        }
     }
 
-    if (u_strcmp(cmd, "cp") == 0) {
-        shell_cmd_cp(shell, "", "");
-        return;
+    if (shown == 0) {
+        shell_println(shell, "log: no matching events");
     }
+}
+
+// Append TSC `cycles` as microseconds with three decimals, the unit of
+// Chrome trace timestamps.
+static void shell_append_trace_us(char *out, UINTN out_len, UINTN *pos, UINT64 cycles, UINT64 hz) {
+    UINT64 ns = (cycles / hz) * 1000000000ULL + ((cycles % hz) * 1000000000ULL) / hz;
+    shell_append_u64(out, out_len, pos, ns / 1000, 0);
+    shell_append(out, out_len, pos, ".");
+    shell_append_u64(out, out_len, pos, ns % 1000, 3);
+}
+
+static void shell_trace_write_span(Shell *shell, ShellStream *stream, const char *name, UINTN category,
+                                   UINT64 start, UINT64 end, UINT64 base, UINT64 hz) {
+    char line[192];
+    UINTN pos = 0;
+    line[0] = '\0';
+    shell_append(line, sizeof(line), &pos, ",\n{\"name\":\"");
+    shell_append(line, sizeof(line), &pos, name);
+    shell_append(line, sizeof(line), &pos, "\",\"cat\":\"");
+    shell_append(line, sizeof(line), &pos, trace_category_name(category));
+    shell_append(line, sizeof(line), &pos, "\",\"ph\":\"X\",\"pid\":1,\"tid\":1,\"ts\":");
+    shell_append_trace_us(line, sizeof(line), &pos, (start > base) ? start - base : 0, hz);
+    shell_append(line, sizeof(line), &pos, ",\"dur\":");
+    shell_append_trace_us(line, sizeof(line), &pos, (end > start) ? end - start : 0, hz);
+    shell_append(line, sizeof(line), &pos, "}");
+    shell_stream_write(shell, stream, line, pos);
+}
 
-    if (u_startswith(cmd, "rm ")) {
-        shell_cmd_rm(shell, u_trim_left(cmd + 3));
+// Write boot phases (from the boot stamps) and every closed span as Chrome
+// Trace Event JSON. Times are relative to efi_main entry.
+static void shell_trace_save(Shell *shell, const char *path) {
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    if (hz == 0) {
+        shell_println(shell, "trace: TSC frequency unknown");
         return;
     }
 
-    if (u_strcmp(cmd, "rm") == 0) {
-        shell_cmd_rm(shell, "");
+    ShellStream stream = {0};
+    EFI_STATUS status = shell_redirect_open(shell, path, FALSE, &stream);
+    if (EFI_ERROR(status)) {
+        shell_print_error_status(shell, "trace save failed", status);
         return;
     }
 
-    if (u_startswith(cmd, "mv ")) {
-        char *args = u_trim_left(cmd + 3);
-        char *src = args;
-        while (*args != '\0' && *args != ' ' && *args != '\t') {
-            args++;
-        }
-        if (*args == '\0') {
-            shell_cmd_mv(shell, "", "");
-            return;
+    static const char header[] =
+        "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+        "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"HatterOS\"}}";
+    shell_stream_write(shell, &stream, header, sizeof(header) - 1);
+
+    UINT64 base = boot_stamp(BOOT_PHASE_ENTRY);
+    for (UINTN phase = 1; phase < BOOT_PHASE_COUNT; phase++) {
+        UINT64 start = boot_stamp((BootPhase)(phase - 1));
+        UINT64 end = boot_stamp((BootPhase)phase);
+        if (start != 0 && end != 0) {
+            shell_trace_write_span(shell, &stream, boot_phase_name((BootPhase)phase), TRACE_CAT_BOOT, start, end, base, hz);
         }
-        *args++ = '\0';
-        char *dst = u_trim_left(args);
-        if (*dst == '\0') {
-            shell_cmd_mv(shell, "", "");
-            return;
+    }
+
+    // The writes below add file spans of their own; stop at the snapshot.
+    // On a full ring those may overwrite a few of the oldest spans first.
+    UINT64 next = trace_next_seq();
+    UINTN written = 0;
+    for (UINT64 seq = trace_first_seq(); seq < next; seq++) {
+        const TraceSpan *span = trace_span(seq);
+        if (span == NULL || span->end == 0) {
+            continue;
         }
-        shell_cmd_mv(shell, src, dst);
-        return;
+        // File spans are named after the call, e.g. "dir->Open"; keep "Open".
+        const char *name = (span->category == TRACE_CAT_FILE) ? shell_call_method(span->name) : span->name;
+        shell_trace_write_span(shell, &stream, name, span->category, span->start, span->end, base, hz);
+        written++;
     }
 
-    if (u_strcmp(cmd, "mv") == 0) {
-        shell_cmd_mv(shell, "", "");
+    static const char footer[] = "\n]}\n";
+    shell_stream_write(shell, &stream, footer, sizeof(footer) - 1);
+    shell_stream_flush(shell, &stream);
+    status = stream.status;
+    if (!EFI_ERROR(status)) {
+        status = SHELL_FILE_CALL(shell, stream.file->Flush, 1, stream.file);
+    }
+    shell_file_close(shell, stream.file);
+    shell_free(shell, stream.buf);
+    if (EFI_ERROR(status)) {
+        shell_print_error_status(shell, "trace write failed", status);
         return;
     }
 
-    if (u_startswith(cmd, "hexdump ")) {
-        shell_cmd_hexdump(shell, u_trim_left(cmd + 8));
-        return;
+    shell_print(shell, "trace: ");
+    shell_print_u64(shell, written);
+    shell_print(shell, " spans written to ");
+    shell_print(shell, path);
+    UINT64 dropped = trace_dropped();
+    if (dropped != 0) {
+        shell_print(shell, " (");
+        shell_print_u64(shell, dropped);
+        shell_print(shell, " older spans overwritten)");
     }
+    shell_putc(shell, '\n');
+}
 
-    if (u_strcmp(cmd, "hexdump") == 0) {
-        shell_cmd_hexdump(shell, "");
+// `trace [save <path>|clear]`: span buffer status, export, or reset.
+static void shell_cmd_trace(Shell *shell, UINTN argc, char **argv) {
+    if (argc == 3 && u_strcmp(argv[1], "save") == 0) {
+        shell_trace_save(shell, argv[2]);
         return;
     }
-
-    if (u_startswith(cmd, "viewbmp ")) {
-        shell_cmd_viewbmp(shell, u_trim_left(cmd + 8));
+    if (argc == 2 && u_strcmp(argv[1], "clear") == 0) {
+        trace_clear();
+        shell_println(shell, "trace: cleared");
         return;
     }
-
-    if (u_strcmp(cmd, "viewbmp") == 0) {
-        shell_cmd_viewbmp(shell, "");
+    if (argc != 1) {
+        shell_println(shell, "trace: usage: trace [save <path>|clear]");
         return;
     }
 
-    if (u_strcmp(cmd, "history") == 0) {
-        shell_cmd_history(shell);
+    shell_print(shell, "trace: ");
+    shell_print_u64(shell, trace_count());
+    shell_print(shell, "/");
+    shell_print_u64(shell, TRACE_SPANS_MAX);
+    shell_print(shell, " spans held, ");
+    shell_print_u64(shell, trace_dropped());
+    shell_println(shell, " older spans overwritten");
+}
+
+// Append this boot's phase times (microseconds) as one CSV line to the boot
+// log, writing the header when the file is new. Failures are silent: a
+// read-only ESP must not get in the way of reaching the prompt.
+static void shell_log_boot(Shell *shell) {
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    BOOLEAN is_new = FALSE;
+    EFI_FILE_PROTOCOL *log = (hz != 0) ? shell_open_log(shell, SHELL_BOOT_LOG_PATH, &is_new) : NULL;
+    if (log == NULL) {
         return;
     }
 
-    if (u_strcmp(cmd, "initfs") == 0) {
-        shell_cmd_initfs(shell);
+    char line[256];
+    UINTN pos = 0;
+    line[0] = '\0';
+
+    if (is_new) {
+        shell_append(line, sizeof(line), &pos, "time,tsc_mhz");
+        for (UINTN phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+            shell_append(line, sizeof(line), &pos, ",");
+            shell_append(line, sizeof(line), &pos, boot_phase_name((BootPhase)phase));
+        }
+        shell_append(line, sizeof(line), &pos, ",to_prompt\n");
+    }
+
+    shell_append_timestamp(shell, line, sizeof(line), &pos);
+    shell_append(line, sizeof(line), &pos, ",");
+    shell_append_u64(line, sizeof(line), &pos, hz / 1000000, 0);
+    for (UINTN phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append_u64(line, sizeof(line), &pos, boot_cycles_to_us(boot_phase_cycles((BootPhase)phase), hz), 0);
+    }
+    UINT64 entry = boot_stamp(BOOT_PHASE_ENTRY);
+    UINT64 prompt = boot_stamp(BOOT_PHASE_PROMPT);
+    shell_append(line, sizeof(line), &pos, ",");
+    shell_append_u64(line, sizeof(line), &pos, (prompt > entry) ? boot_cycles_to_us(prompt - entry, hz) : 0, 0);
+    shell_append(line, sizeof(line), &pos, "\n");
+
+    UINTN write_size = pos;
+    shell_file_write(shell, log, &write_size, line);
+    shell_file_close(shell, log);
+}
+
+// `perf <command line>`: run the command and print what it cost. Counters are
+// snapshotted around the dispatch, so perf's own report is not included.
+// `perf` used as a pipeline stage (`ls | perf cat`): time the stage's own
+// text. A line starting with `perf` never gets here with more than the
+// command name; shell_execute hands the rest of the line to shell_perf_run.
+static void shell_cmd_perf(Shell *shell, UINTN argc, char **argv) {
+    char line[SHELL_INPUT_MAX];
+    if (shell_args_text(shell, argc, argv, line, sizeof(line))) {
+        shell_perf_run(shell, line);
+    } else {
+        shell_dispatch(shell, argc - 1, argv + 1);
+    }
+}
+
+// Run `line` through shell_execute, so operators and a redirect's final
+// write and Flush are inside the measurement, then report the cost on the
+// console rather than into the measured command's output.
+static void shell_perf_run(Shell *shell, const char *line) {
+    char inner[SHELL_INPUT_MAX];
+    UINTN len = 0;
+    while (line[len] != '\0' && len + 1 < sizeof(inner)) {
+        inner[len] = line[len];
+        len++;
+    }
+    inner[len] = '\0';
+
+    ShellStream *out = shell->out;
+    ShellStream *in = shell->in;
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    ShellCounters before = shell->counters;
+    GfxCounters gfx_before = shell->gfx->counters;
+    UINT64 start = cpu_rdtsc();
+
+    // Include the repaint and present the command's output would otherwise
+    // get at the next prompt.
+    shell_execute(shell, inner);
+    shell_sync_screen(shell);
+    gfx_present(shell->gfx);
+
+    UINT64 cycles = cpu_rdtsc() - start;
+    ShellCounters after = shell->counters;
+    GfxCounters gfx_after = shell->gfx->counters;
+
+    shell->out = NULL;
+    shell->in = NULL;
+
+    shell_print(shell, "perf: ");
+    shell_print_u64(shell, cycles);
+    shell_print(shell, " cycles, ");
+    shell_print_u64(shell, boot_cycles_to_us(cycles, hz));
+    shell_println(shell, " us");
+    shell_print(shell, "  alloc:  ");
+    shell_print_u64(shell, after.allocs - before.allocs);
+    shell_print(shell, " calls (");
+    shell_print_u64(shell, after.pool_allocs - before.pool_allocs);
+    shell_print(shell, " from pool), ");
+    shell_print_u64(shell, after.alloc_bytes - before.alloc_bytes);
+    shell_println(shell, " bytes");
+    shell_print(shell, "  file:   ");
+    shell_print_u64(shell, after.file_calls - before.file_calls);
+    shell_print(shell, " calls, ");
+    shell_print_u64(shell, after.file_read_bytes - before.file_read_bytes);
+    shell_print(shell, " bytes read, ");
+    shell_print_u64(shell, after.file_write_bytes - before.file_write_bytes);
+    shell_println(shell, " bytes written");
+    shell_print(shell, "  render: ");
+    shell_print_u64(shell, gfx_after.glyphs - gfx_before.glyphs);
+    shell_print(shell, " glyphs (");
+    shell_print_u64(shell, gfx_after.glyph_pixels - gfx_before.glyph_pixels);
+    shell_print(shell, " px), ");
+    shell_print_u64(shell, gfx_after.presents - gfx_before.presents);
+    shell_print(shell, " rects presented (");
+    shell_print_u64(shell, gfx_after.present_pixels - gfx_before.present_pixels);
+    shell_println(shell, " px)");
+    shell->out = out;
+    shell->in = in;
+}
+
+static void shell_bench_add(ShellBenchResult *results, UINTN *count, const char *name, UINTN chunk, UINT64 value, const char *unit) {
+    if (*count >= SHELL_BENCH_RESULTS_MAX) {
         return;
     }
+    ShellBenchResult *r = &results[(*count)++];
+    UINTN pos = 0;
+    r->name[0] = '\0';
+    shell_append(r->name, sizeof(r->name), &pos, name);
+    if (chunk != 0) {
+        shell_append(r->name, sizeof(r->name), &pos, " ");
+        if (chunk >= 1024 * 1024) {
+            shell_append_u64(r->name, sizeof(r->name), &pos, chunk / (1024 * 1024), 0);
+            shell_append(r->name, sizeof(r->name), &pos, "M");
+        } else {
+            shell_append_u64(r->name, sizeof(r->name), &pos, chunk / 1024, 0);
+            shell_append(r->name, sizeof(r->name), &pos, "K");
+        }
+    }
+    r->value = value;
+    r->unit = unit;
+}
+
+// Units per second for `units` done in `cycles` TSC ticks.
+static UINT64 shell_bench_rate(UINT64 units, UINT64 cycles, UINT64 hz) {
+    if (cycles == 0) {
+        return 0;
+    }
+    if (units <= 0xFFFFFFFFFFFFFFFFULL / hz) {
+        return units * hz / cycles;
+    }
+    return units / cycles * hz;
+}
+
+// Fill, glyph, Blt and present throughput. Draws over the whole screen; the
+// caller restores it afterwards.
+static void shell_bench_gfx(Shell *shell, UINT64 hz, ShellBenchResult *results, UINTN *count) {
+    GfxContext *gfx = shell->gfx;
+    UINT64 screen_px = (UINT64)gfx->width * gfx->height;
+
+    UINT64 start = cpu_rdtsc();
+    for (UINTN i = 0; i < SHELL_BENCH_GFX_ROUNDS; i++) {
+        gfx_fill_rect(gfx, 0, 0, gfx->width, gfx->height, (i & 1) ? shell->fg_color : shell->bg_color);
+    }
+    UINT64 cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "fill", 0, shell_bench_rate(screen_px * SHELL_BENCH_GFX_ROUNDS, cycles, hz) / 1000000, "Mpx/s");
+
+    char text[SHELL_INPUT_MAX];
+    UINTN run = (shell->cols < sizeof(text)) ? shell->cols : sizeof(text);
+    for (UINTN i = 0; i < run; i++) {
+        text[i] = (char)('!' + i % 94);
+    }
+    start = cpu_rdtsc();
+    for (UINTN i = 0; i < SHELL_BENCH_GFX_ROUNDS; i++) {
+        for (UINTN row = 0; row < shell->rows; row++) {
+            font_draw_run(gfx, shell->margin_x, shell->margin_y + row * FONT_CHAR_HEIGHT, text, run, shell->fg_color, shell->bg_color);
+        }
+    }
+    cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "glyphs", 0, shell_bench_rate((UINT64)run * shell->rows * SHELL_BENCH_GFX_ROUNDS, cycles, hz), "glyph/s");
 
-    if (u_startswith(cmd, "theme ")) {
-        shell_cmd_theme(shell, u_trim_left(cmd + 6));
+    if (gfx->has_backbuffer) {
+        start = cpu_rdtsc();
+        for (UINTN i = 0; i < SHELL_BENCH_GFX_ROUNDS; i++) {
+            gfx_mark_dirty(gfx, 0, 0, gfx->width, gfx->height);
+            gfx_present(gfx);
+        }
+        cycles = cpu_rdtsc() - start;
+        shell_bench_add(results, count, "present", 0, shell_bench_rate(screen_px * 4 * SHELL_BENCH_GFX_ROUNDS, cycles, hz) / 1000000, "MB/s");
+    }
+
+    if (gfx->gop == NULL || gfx->gop->Blt == NULL) {
         return;
     }
 
-    if (u_strcmp(cmd, "theme") == 0) {
-        shell_cmd_theme(shell, "");
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL fill_px = {0x40, 0x30, 0x20, 0};
+    start = cpu_rdtsc();
+    for (UINTN i = 0; i < SHELL_BENCH_GFX_ROUNDS; i++) {
+        uefi_call_wrapper(gfx->gop->Blt, 10, gfx->gop, &fill_px, EfiBltVideoFill, 0, 0, 0, 0, gfx->width, gfx->height, 0);
+    }
+    cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "blt videofill", 0, shell_bench_rate(screen_px * 4 * SHELL_BENCH_GFX_ROUNDS, cycles, hz) / 1000000, "MB/s");
+
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL *buf = (EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)shell_alloc(shell, (UINTN)screen_px * sizeof(*buf));
+    if (buf == NULL) {
         return;
     }
+    for (UINTN i = 0; i < screen_px; i++) {
+        buf[i] = fill_px;
+    }
+    start = cpu_rdtsc();
+    for (UINTN i = 0; i < SHELL_BENCH_GFX_ROUNDS; i++) {
+        uefi_call_wrapper(gfx->gop->Blt, 10, gfx->gop, buf, EfiBltBufferToVideo, 0, 0, 0, 0, gfx->width, gfx->height, gfx->width * sizeof(*buf));
+    }
+    cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "blt buf->video", 0, shell_bench_rate(screen_px * 4 * SHELL_BENCH_GFX_ROUNDS, cycles, hz) / 1000000, "MB/s");
+    shell_free(shell, buf);
+}
+
+// Average cost of one output line that scrolls the console, including the
+// repaint and present the prompt loop would do.
+static void shell_bench_scroll(Shell *shell, UINT64 hz, ShellBenchResult *results, UINTN *count) {
+    while (shell->cursor_row + 1 < shell->rows) {
+        shell_putc(shell, '\n');
+    }
+    shell_sync_screen(shell);
+    gfx_present(shell->gfx);
+
+    UINT64 start = cpu_rdtsc();
+    for (UINTN i = 0; i < shell->rows; i++) {
+        shell_println(shell, "bench: scroll");
+        shell_sync_screen(shell);
+        gfx_present(shell->gfx);
+    }
+    UINT64 cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "scroll", 0, boot_cycles_to_us(cycles / shell->rows, hz), "us/line");
+}
+
+// Sequential write then read of a SHELL_BENCH_FILE_BYTES scratch file at
+// each chunk size. Writes include the final Flush; reads may be served from
+// the firmware's block cache since the file was just written.
+static EFI_STATUS shell_bench_fat(Shell *shell, UINT64 hz, ShellBenchResult *results, UINTN *count) {
+    static const UINTN chunks[] = {4096, 65536, 1024 * 1024};
+    EFI_STATUS status = shell_ensure_dir_tree(shell, SHELL_BENCH_TMP_DIR);
+    if (EFI_ERROR(status)) {
+        return status;
+    }
+
+    UINT8 *buf = (UINT8 *)shell_alloc(shell, chunks[sizeof(chunks) / sizeof(chunks[0]) - 1]);
+    if (buf == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+    for (UINTN i = 0; i < chunks[sizeof(chunks) / sizeof(chunks[0]) - 1]; i++) {
+        buf[i] = (UINT8)i;
+    }
+
+    for (UINTN c = 0; c < sizeof(chunks) / sizeof(chunks[0]) && !EFI_ERROR(status); c++) {
+        UINTN chunk = chunks[c];
+        EFI_FILE_PROTOCOL *file = NULL;
+
+        // Start from an empty file so every pass allocates clusters.
+        if (!EFI_ERROR(shell_open_path(shell, SHELL_BENCH_TMP_PATH, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0, &file))) {
+            SHELL_FILE_CALL(shell, file->Delete, 1, file);
+        }
+        status = shell_open_path(
+            shell,
+            SHELL_BENCH_TMP_PATH,
+            EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+            0,
+            &file
+        );
+        if (EFI_ERROR(status)) {
+            break;
+        }
+
+        UINT64 start = cpu_rdtsc();
+        for (UINTN done = 0; done < SHELL_BENCH_FILE_BYTES && !EFI_ERROR(status); done += chunk) {
+            UINTN size = chunk;
+            status = shell_file_write(shell, file, &size, buf);
+        }
+        if (!EFI_ERROR(status)) {
+            status = SHELL_FILE_CALL(shell, file->Flush, 1, file);
+        }
+        UINT64 cycles = cpu_rdtsc() - start;
+        shell_file_close(shell, file);
+        if (EFI_ERROR(status)) {
+            break;
+        }
+        shell_bench_add(results, count, "fat write", chunk, shell_bench_rate(SHELL_BENCH_FILE_BYTES, cycles, hz) / 1000000, "MB/s");
+
+        status = shell_open_path(shell, SHELL_BENCH_TMP_PATH, EFI_FILE_MODE_READ, 0, &file);
+        if (EFI_ERROR(status)) {
+            break;
+        }
+        UINT64 total = 0;
+        start = cpu_rdtsc();
+        for (;;) {
+            UINTN size = chunk;
+            status = shell_file_read(shell, file, &size, buf);
+            if (EFI_ERROR(status) || size == 0) {
+                break;
+            }
+            total += size;
+        }
+        cycles = cpu_rdtsc() - start;
+        shell_file_close(shell, file);
+        if (!EFI_ERROR(status)) {
+            shell_bench_add(results, count, "fat read", chunk, shell_bench_rate(total, cycles, hz) / 1000000, "MB/s");
+        }
+    }
+
+    EFI_FILE_PROTOCOL *file = NULL;
+    if (!EFI_ERROR(shell_open_path(shell, SHELL_BENCH_TMP_PATH, EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE, 0, &file))) {
+        SHELL_FILE_CALL(shell, file->Delete, 1, file);
+    }
+    shell_free(shell, buf);
+    return status;
+}
+
+// One-page AllocatePool/FreePool vs AllocatePages/FreePages pairs per second.
+static void shell_bench_alloc(Shell *shell, UINT64 hz, ShellBenchResult *results, UINTN *count) {
+    EFI_BOOT_SERVICES *bs = shell->st->BootServices;
+    UINTN done = 0;
+    UINT64 start = cpu_rdtsc();
+    for (; done < SHELL_BENCH_ALLOC_ROUNDS; done++) {
+        void *ptr = NULL;
+        if (EFI_ERROR(uefi_call_wrapper(bs->AllocatePool, 3, EfiLoaderData, EFI_PAGE_SIZE, &ptr))) {
+            break;
+        }
+        uefi_call_wrapper(bs->FreePool, 1, ptr);
+    }
+    UINT64 cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "AllocatePool 4K", 0, shell_bench_rate(done, cycles, hz), "pairs/s");
 
-    if (u_strcmp(cmd, "time") == 0) {
-        shell_cmd_time(shell);
+    done = 0;
+    start = cpu_rdtsc();
+    for (; done < SHELL_BENCH_ALLOC_ROUNDS; done++) {
+        EFI_PHYSICAL_ADDRESS addr = 0;
+        if (EFI_ERROR(uefi_call_wrapper(bs->AllocatePages, 4, AllocateAnyPages, EfiLoaderData, 1, &addr))) {
+            break;
+        }
+        uefi_call_wrapper(bs->FreePages, 2, addr, 1);
+    }
+    cycles = cpu_rdtsc() - start;
+    shell_bench_add(results, count, "AllocatePages 4K", 0, shell_bench_rate(done, cycles, hz), "pairs/s");
+}
+
+// Append one CSV row per result to the bench log, all sharing this run's
+// timestamp. Returns FALSE when the log could not be written.
+static BOOLEAN shell_bench_log(Shell *shell, UINT64 hz, const ShellBenchResult *results, UINTN count) {
+    BOOLEAN is_new = FALSE;
+    EFI_FILE_PROTOCOL *log = shell_open_log(shell, SHELL_BENCH_LOG_PATH, &is_new);
+    if (log == NULL) {
+        return FALSE;
+    }
+
+    EFI_STATUS status = EFI_SUCCESS;
+    char line[160];
+    UINTN pos = 0;
+    if (is_new) {
+        shell_append(line, sizeof(line), &pos, "time,tsc_mhz,resolution,fill_kernel,test,value,unit\n");
+        UINTN size = pos;
+        status = shell_file_write(shell, log, &size, line);
+    }
+
+    for (UINTN i = 0; i < count && !EFI_ERROR(status); i++) {
+        pos = 0;
+        line[0] = '\0';
+        shell_append_timestamp(shell, line, sizeof(line), &pos);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append_u64(line, sizeof(line), &pos, hz / 1000000, 0);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append_u64(line, sizeof(line), &pos, shell->gfx->width, 0);
+        shell_append(line, sizeof(line), &pos, "x");
+        shell_append_u64(line, sizeof(line), &pos, shell->gfx->height, 0);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append(line, sizeof(line), &pos, shell->gfx->fill_kernel);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append(line, sizeof(line), &pos, results[i].name);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append_u64(line, sizeof(line), &pos, results[i].value, 0);
+        shell_append(line, sizeof(line), &pos, ",");
+        shell_append(line, sizeof(line), &pos, results[i].unit);
+        shell_append(line, sizeof(line), &pos, "\n");
+        UINTN size = pos;
+        status = shell_file_write(shell, log, &size, line);
+    }
+    shell_file_close(shell, log);
+    return !EFI_ERROR(status);
+}
+
+// `bench`: firmware-side throughput table, appended to the bench log.
+static void shell_cmd_bench(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    UINT64 hz = cpu_tsc_hz(shell->st->BootServices);
+    if (hz == 0) {
+        shell_println(shell, "bench: TSC frequency unknown");
         return;
     }
 
-    if (u_strcmp(cmd, "memmap") == 0) {
-        shell_cmd_memmap(shell);
+    ShellBenchResult results[SHELL_BENCH_RESULTS_MAX];
+    UINTN count = 0;
+
+    shell_println(shell, "bench: running...");
+    shell_sync_screen(shell);
+    gfx_present(shell->gfx);
+
+    shell_bench_gfx(shell, hz, results, &count);
+    shell_restore_screen(shell);
+    shell_bench_scroll(shell, hz, results, &count);
+    EFI_STATUS fat_status = shell_bench_fat(shell, hz, results, &count);
+    shell_bench_alloc(shell, hz, results, &count);
+
+    if (EFI_ERROR(fat_status)) {
+        shell_print_error_status(shell, "bench: fat test failed", fat_status);
+    }
+    for (UINTN i = 0; i < count; i++) {
+        shell_print(shell, "  ");
+        shell_print(shell, results[i].name);
+        for (UINTN len = u_strlen(results[i].name); len < 18; len++) {
+            shell_putc(shell, ' ');
+        }
+        char value[32];
+        u_u64_to_dec(results[i].value, value, sizeof(value));
+        for (UINTN len = u_strlen(value); len < 12; len++) {
+            shell_putc(shell, ' ');
+        }
+        shell_print(shell, value);
+        shell_print(shell, " ");
+        shell_println(shell, results[i].unit);
+    }
+    if (shell_bench_log(shell, hz, results, count)) {
+        shell_println(shell, "Logged to /HATTEROS/system/log/bench.csv");
+    } else {
+        shell_println(shell, "bench: could not write /HATTEROS/system/log/bench.csv");
+    }
+}
+
+// Print runtime/system metadata for debugging.
+static void shell_cmd_info(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    char w[32], h[32], fb_addr[32], fb_size[32];
+    u_u64_to_dec(shell->gfx->width, w, sizeof(w));
+    u_u64_to_dec(shell->gfx->height, h, sizeof(h));
+    u_u64_to_hex((UINT64)shell->gfx->framebuffer_base, fb_addr, sizeof(fb_addr));
+    u_u64_to_dec(shell->gfx->framebuffer_size, fb_size, sizeof(fb_size));
+
+    shell_println(shell, "HatterOS stage-0 shell");
+    shell_print(shell, "Version: ");
+    shell_println(shell, HATTEROS_VERSION);
+    shell_print(shell, "Build: ");
+    shell_println(shell, HATTEROS_BUILD_DATE);
+    shell_print(shell, "Resolution: ");
+    shell_print(shell, w);
+    shell_print(shell, "x");
+    shell_println(shell, h);
+    shell_print(shell, "Framebuffer: ");
+    shell_println(shell, fb_addr);
+    shell_print(shell, "Framebuffer size: ");
+    shell_print(shell, fb_size);
+    shell_println(shell, " bytes");
+    shell_print(shell, "Pixel format: ");
+    shell_println(shell, shell->gfx->format->name);
+    shell_print(shell, "Back buffer: ");
+    shell_println(shell, shell->gfx->has_backbuffer ? "yes" : "no");
+    shell_print(shell, "Fill kernel: ");
+    shell_println(shell, shell->gfx->fill_kernel);
+    shell_print(shell, "BMP kernel: ");
+    shell_println(shell, shell->gfx->bmp_kernel);
+    char sinks[64];
+    console_describe(shell->console.sinks, sinks, sizeof(sinks));
+    shell_print(shell, "Console: ");
+    shell_println(shell, sinks);
+}
+
+static void shell_cmd_help(Shell *shell, UINTN argc, char **argv) {
+    shell_print_help(shell, (argc > 1) ? argv[1] : "");
+}
+
+static void shell_cmd_clear(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    shell_clear(shell);
+}
+
+// Copy argv[1..argc) as typed on the running line: the text from the first
+// argument through the last, spacing and quotes kept. FALSE when there are
+// no arguments or they did not come from shell_execute's line.
+static BOOLEAN shell_args_text(Shell *shell, UINTN argc, char **argv, char *out, UINTN out_len) {
+    if (argc < 2 || shell->line == NULL || shell_is_operator(argv[1]) || shell_is_operator(argv[argc - 1])) {
+        return FALSE;
+    }
+    const char *line = shell->line;
+    UINTN start = (UINTN)(argv[1] - shell->line_words);
+    UINTN end = (UINTN)(argv[argc - 1] - shell->line_words) + u_strlen(argv[argc - 1]);
+    if (start > 0 && line[start - 1] == '"') {
+        start--;
+    }
+    if (line[end] == '"') {
+        end++;
+    }
+    UINTN n = 0;
+    for (UINTN i = start; i < end && n + 1 < out_len; i++) {
+        out[n++] = line[i];
+    }
+    out[n] = '\0';
+    return TRUE;
+}
+
+// Print the arguments as typed. Joins argv with spaces if not run from a line.
+static void shell_cmd_echo(Shell *shell, UINTN argc, char **argv) {
+    char text[SHELL_INPUT_MAX];
+    if (shell_args_text(shell, argc, argv, text, sizeof(text))) {
+        shell_println(shell, text);
         return;
     }
+    for (UINTN i = 1; i < argc; i++) {
+        if (i > 1) {
+            shell_putc(shell, ' ');
+        }
+        shell_print(shell, argv[i]);
+    }
+    shell_putc(shell, '\n');
+}
+
+static void shell_cmd_reboot(Shell *shell, UINTN argc, char **argv) {
+    (void)argc;
+    (void)argv;
+    shell_println(shell, "Rebooting...");
+    shell_flush_events(shell, TRUE);
+    console_flush(&shell->console);
+    uefi_call_wrapper(shell->st->RuntimeServices->ResetSystem, 4, EfiResetWarm, EFI_SUCCESS, 0, NULL);
+}
+
+// Pipeline operators. The tokenizer returns these exact pointers, so a quoted
+// "|" or ">" stays an ordinary word.
+static char shell_op_pipe[] = "|";
+static char shell_op_write[] = ">";
+static char shell_op_append[] = ">>";
 
-    shell_print(shell, "Unknown command: ");
-    shell_println(shell, cmd);
-    shell_println(shell, "Type 'help' for available commands.");
+static BOOLEAN shell_is_operator(const char *word) {
+    return word == shell_op_pipe || word == shell_op_write || word == shell_op_append;
+}
+
+// Split `line` into at most max_args words. `words` receives a copy of the
+// line (up to words_len - 1 bytes) with each word terminated in place, so a
+// word's offset in `words` is its offset in `line`. Words are separated by
+// spaces or tabs; a word starting with '"' runs to the closing quote, so
+// paths with spaces can be passed. Unquoted '|', '>' and '>>' become operator
+// words even without surrounding spaces. Returns max_args + 1 when the line
+// has more words than fit.
+static UINTN shell_tokenize(const char *line, char *words, UINTN words_len, char **argv, UINTN max_args) {
+    UINTN len = 0;
+    while (line[len] != '\0' && len + 1 < words_len) {
+        words[len] = line[len];
+        len++;
+    }
+    words[len] = '\0';
+
+    UINTN argc = 0;
+    UINTN i = 0;
+    while (1) {
+        while (i < len && (line[i] == ' ' || line[i] == '\t')) {
+            i++;
+        }
+        if (i == len) {
+            return argc;
+        }
+        if (argc == max_args) {
+            return max_args + 1;
+        }
+
+        if (line[i] == '|') {
+            argv[argc++] = shell_op_pipe;
+            i++;
+            continue;
+        }
+        if (line[i] == '>') {
+            BOOLEAN append = (i + 1 < len && line[i + 1] == '>');
+            argv[argc++] = append ? shell_op_append : shell_op_write;
+            i += append ? 2 : 1;
+            continue;
+        }
+
+        // The separator, operator or closing quote after a word becomes its
+        // terminator; `line` still has the original character.
+        if (line[i] == '"') {
+            i++;
+            argv[argc++] = &words[i];
+            while (i < len && line[i] != '"') {
+                i++;
+            }
+            words[i] = '\0';
+            if (i < len) {
+                i++;
+            }
+        } else {
+            argv[argc++] = &words[i];
+            while (i < len && line[i] != ' ' && line[i] != '\t' && line[i] != '|' && line[i] != '>') {
+                i++;
+            }
+            words[i] = '\0';
+        }
+    }
+}
+
+// Binary search of the sorted command table.
+static const ShellCommand *shell_find_command(const char *name) {
+    UINTN lo = 0;
+    UINTN hi = SHELL_COMMAND_COUNT;
+    while (lo < hi) {
+        UINTN mid = lo + (hi - lo) / 2;
+        INTN cmp = u_strcmp(name, shell_commands[mid].name);
+        if (cmp == 0) {
+            return &shell_commands[mid];
+        }
+        if (cmp < 0) {
+            hi = mid;
+        } else {
+            lo = mid + 1;
+        }
+    }
+    return NULL;
+}
+
+// Run one tokenized command after checking its argument count.
+static void shell_dispatch(Shell *shell, UINTN argc, char **argv) {
+    const ShellCommand *command = shell_find_command(argv[0]);
+    if (command == NULL) {
+        evlog_write(EVLOG_SYS_SHELL, EVLOG_LEVEL_INFO, EVLOG_SHELL_UNKNOWN, 0, evlog_tag(argv[0]));
+        shell_print(shell, "Unknown command: ");
+        shell_println(shell, argv[0]);
+        shell_println(shell, "Type 'help' for available commands.");
+        return;
+    }
+
+    UINTN args = argc - 1;
+    if (args < command->min_args || (command->max_args != SHELL_ARGS_ANY && args > command->max_args)) {
+        shell_print(shell, command->name);
+        shell_print(shell, ": usage: ");
+        shell_println(shell, command->usage);
+        return;
+    }
+    trace_begin(TRACE_CAT_SHELL, command->name);
+    command->fn(shell, argc, argv);
+    trace_end();
+}
+
+// Read up to *size bytes from `file`, or from the piped input when file is
+// NULL. *size is set to 0 at end of input.
+static EFI_STATUS shell_input_read(Shell *shell, EFI_FILE_PROTOCOL *file, UINTN *size, void *buf) {
+    if (file != NULL) {
+        return shell_file_read(shell, file, size, buf);
+    }
+
+    ShellStream *in = shell->in;
+    UINTN avail = (in != NULL) ? in->len - in->read_pos : 0;
+    UINTN n = (*size < avail) ? *size : avail;
+    UINT8 *dst = (UINT8 *)buf;
+    for (UINTN i = 0; i < n; i++) {
+        dst[i] = (UINT8)in->buf[in->read_pos + i];
+    }
+    if (in != NULL) {
+        in->read_pos += n;
+    }
+    *size = n;
+    return EFI_SUCCESS;
+}
+
+// Append n bytes to a pipe or redirect. A full redirect buffer is written out
+// with one file call; a full pipe keeps what fits and marks itself truncated.
+static void shell_stream_write(Shell *shell, ShellStream *stream, const char *data, UINTN n) {
+    while (n > 0) {
+        if (stream->len == stream->cap) {
+            if (stream->file == NULL) {
+                stream->truncated = TRUE;
+                return;
+            }
+            shell_stream_flush(shell, stream);
+            if (EFI_ERROR(stream->status)) {
+                return;
+            }
+        }
+
+        UINTN room = stream->cap - stream->len;
+        UINTN chunk = (n < room) ? n : room;
+        for (UINTN i = 0; i < chunk; i++) {
+            stream->buf[stream->len + i] = data[i];
+        }
+        stream->len += chunk;
+        data += chunk;
+        n -= chunk;
+    }
+}
+
+// Write a redirect's buffered bytes to its file. The first error sticks and
+// later output is discarded.
+static void shell_stream_flush(Shell *shell, ShellStream *stream) {
+    if (stream->file == NULL || stream->len == 0 || EFI_ERROR(stream->status)) {
+        stream->len = 0;
+        return;
+    }
+    UINTN size = stream->len;
+    stream->status = shell_file_write(shell, stream->file, &size, stream->buf);
+    if (!EFI_ERROR(stream->status) && size != stream->len) {
+        stream->status = EFI_DEVICE_ERROR;
+    }
+    stream->len = 0;
+}
+
+// Open the target of `> path` (truncated) or `>> path` (appended to) and
+// give it a write buffer. The buffer is allocated first so running out of
+// memory leaves the file untouched.
+static EFI_STATUS shell_redirect_open(Shell *shell, const char *path, BOOLEAN append, ShellStream *stream) {
+    char *buf = (char *)shell_alloc(shell, SHELL_REDIRECT_BUF);
+    if (buf == NULL) {
+        return EFI_OUT_OF_RESOURCES;
+    }
+
+    EFI_FILE_PROTOCOL *file = NULL;
+    EFI_STATUS status = shell_open_path(
+        shell,
+        path,
+        EFI_FILE_MODE_READ | EFI_FILE_MODE_WRITE | EFI_FILE_MODE_CREATE,
+        0,
+        &file
+    );
+    if (EFI_ERROR(status) || file == NULL) {
+        shell_free(shell, buf);
+        return EFI_ERROR(status) ? status : EFI_NOT_FOUND;
+    }
+
+    EFI_STATUS info_status = EFI_SUCCESS;
+    EFI_FILE_INFO *info = shell_get_file_info(shell, file, &info_status);
+    if (info == NULL) {
+        shell_file_close(shell, file);
+        shell_free(shell, buf);
+        return info_status;
+    }
+    if ((info->Attribute & EFI_FILE_DIRECTORY) != 0) {
+        shell_free(shell, info);
+        shell_file_close(shell, file);
+        shell_free(shell, buf);
+        return EFI_ACCESS_DENIED;
+    }
+
+    if (append) {
+        // Seeking to the all-ones position moves to end of file.
+        status = SHELL_FILE_CALL(shell, file->SetPosition, 2, file, 0xFFFFFFFFFFFFFFFFULL);
+    } else if (info->FileSize != 0) {
+        EFI_GUID file_info_guid = EFI_FILE_INFO_ID;
+        info->FileSize = 0;
+        info->PhysicalSize = 0;
+        status = SHELL_FILE_CALL(shell, file->SetInfo, 4, file, &file_info_guid, info->Size, info);
+    }
+    shell_free(shell, info);
+    if (EFI_ERROR(status)) {
+        shell_file_close(shell, file);
+        shell_free(shell, buf);
+        return status;
+    }
+
+    stream->buf = buf;
+    stream->cap = SHELL_REDIRECT_BUF;
+    stream->file = file;
+    return EFI_SUCCESS;
+}
+
+// Run `stage | stage ... [> path | >> path]`. Each stage runs to completion
+// with its output in a bounded in-memory pipe that the next stage reads; the
+// last stage writes to the console or the redirect file.
+static void shell_run_pipeline(Shell *shell, UINTN argc, char **argv) {
+    UINTN end = argc;
+    const char *redirect_path = NULL;
+    BOOLEAN append = FALSE;
+    UINTN stages = 1;
+    for (UINTN i = 0; i < argc; i++) {
+        if (argv[i] == shell_op_pipe) {
+            if (i == 0 || i + 1 >= end || shell_is_operator(argv[i + 1])) {
+                shell_println(shell, "syntax error near '|'");
+                return;
+            }
+            stages++;
+        } else if (argv[i] == shell_op_write || argv[i] == shell_op_append) {
+            if (i == 0 || i + 2 != argc || shell_is_operator(argv[i + 1])) {
+                shell_print(shell, "syntax error near '");
+                shell_print(shell, argv[i]);
+                shell_println(shell, "'");
+                return;
+            }
+            end = i;
+            redirect_path = argv[i + 1];
+            append = (argv[i] == shell_op_append);
+            break;
+        }
+    }
+
+    // Everything that can fail goes before the redirect is opened, so a
+    // `>` target is only truncated when the pipeline will actually run.
+    ShellStream redirect = {0};
+    ShellStream pipes[2] = {{0}, {0}};
+    for (UINTN i = 0; i < 2 && i + 1 < stages; i++) {
+        pipes[i].buf = (char *)shell_alloc(shell, SHELL_PIPE_MAX);
+        pipes[i].cap = SHELL_PIPE_MAX;
+        if (pipes[i].buf == NULL) {
+            shell_println(shell, "pipe: out of memory");
+            shell_free(shell, pipes[0].buf);
+            return;
+        }
+    }
+    if (redirect_path != NULL) {
+        EFI_STATUS status = shell_redirect_open(shell, redirect_path, append, &redirect);
+        if (EFI_ERROR(status)) {
+            shell_print_error_status(shell, "redirect open failed", status);
+            for (UINTN i = 0; i < 2; i++) {
+                shell_free(shell, pipes[i].buf);
+            }
+            return;
+        }
+    }
+
+    const char *truncated = NULL;
+    UINTN start = 0;
+    for (UINTN stage = 0; stage < stages; stage++) {
+        UINTN stop = start;
+        while (stop < end && argv[stop] != shell_op_pipe) {
+            stop++;
+        }
+
+        ShellStream *out = (stage + 1 < stages) ? &pipes[stage & 1] : ((redirect_path != NULL) ? &redirect : NULL);
+        if (out != NULL && out->file == NULL) {
+            out->len = 0;
+            out->read_pos = 0;
+            out->truncated = FALSE;
+        }
+        shell->in = (stage > 0) ? &pipes[(stage - 1) & 1] : NULL;
+        shell->out = out;
+        shell_dispatch(shell, stop - start, &argv[start]);
+        shell->in = NULL;
+        shell->out = NULL;
+
+        if (out != NULL && out->truncated && truncated == NULL) {
+            truncated = argv[start];
+        }
+        start = stop + 1;
+    }
+
+    for (UINTN i = 0; i < 2; i++) {
+        if (pipes[i].buf != NULL) {
+            shell_free(shell, pipes[i].buf);
+        }
+    }
+    if (redirect.file != NULL) {
+        shell_stream_flush(shell, &redirect);
+        EFI_STATUS status = redirect.status;
+        if (!EFI_ERROR(status)) {
+            status = SHELL_FILE_CALL(shell, redirect.file->Flush, 1, redirect.file);
+        }
+        shell_file_close(shell, redirect.file);
+        shell_free(shell, redirect.buf);
+        if (EFI_ERROR(status)) {
+            shell_print_error_status(shell, "redirect write failed", status);
+        }
+    }
+    if (truncated != NULL) {
+        shell_print(shell, truncated);
+        shell_println(shell, ": pipe full, output truncated at 64 KiB");
+    }
+}
+
+// Parse and dispatch one command line.
+static void shell_execute(Shell *shell, char *line) {
+    char words[SHELL_INPUT_MAX];
+    char *argv[SHELL_ARGV_MAX];
+    UINTN argc = shell_tokenize(line, words, sizeof(words), argv, SHELL_ARGV_MAX);
+    if (argc == 0) {
+        return;
+    }
+    if (argc > SHELL_ARGV_MAX) {
+        shell_println(shell, "Too many arguments.");
+        return;
+    }
+
+    // `perf` owns the rest of its line, operators included, so it measures
+    // the whole pipeline and its report stays out of any redirect.
+    if (argc > 1 && u_strcmp(argv[0], "perf") == 0) {
+        UINTN rest = (UINTN)(argv[0] - words) + u_strlen(argv[0]);
+        if (line[rest] == '"') {
+            rest++;
+        }
+        shell_perf_run(shell, line + rest);
+        return;
+    }
+
+    // perf runs its command line through here again, so restore the outer
+    // line afterwards.
+    const char *outer_line = shell->line;
+    const char *outer_words = shell->line_words;
+    trace_begin(TRACE_CAT_SHELL, "execute");
+    shell->line = line;
+    shell->line_words = words;
+    BOOLEAN pipeline = FALSE;
+    for (UINTN i = 0; i < argc && !pipeline; i++) {
+        pipeline = shell_is_operator(argv[i]);
+    }
+    if (pipeline) {
+        shell_run_pipeline(shell, argc, argv);
+    } else {
+        shell_dispatch(shell, argc, argv);
+    }
+    shell->line = outer_line;
+    shell->line_words = outer_words;
+    trace_end();
 }
 
 // Main REPL loop.
@@ -2307,9 +4083,16 @@ void shell_run(Shell *shell) {
 
     shell_println(shell, "HatterOS shell ready. Type 'help'.");
 
+    BOOLEAN boot_logged = FALSE;
     while (1) {
         char input[SHELL_INPUT_MAX];
         shell_prompt(shell);
+        if (!boot_logged) {
+            boot_mark(BOOT_PHASE_PROMPT);
+            shell_log_boot(shell);
+        }
+        shell_flush_events(shell, !boot_logged);
+        boot_logged = TRUE;
 
         EFI_STATUS status = shell_read_line(shell, input, sizeof(input));
         if (EFI_ERROR(status)) {
@@ -2319,5 +4102,6 @@ void shell_run(Shell *shell) {
 
         shell_history_add(shell, u_trim_left(input));
         shell_execute(shell, input);
+        shell_arena_reset(shell);
     }
 }
@@ -3,10 +3,59 @@
 
 #include <efi.h>
 #include "gfx.h"
+#include "console.h"
 
 #define SHELL_PATH_MAX 260
 #define SHELL_INPUT_MAX 256
 #define SHELL_HISTORY_MAX 16
+#define SHELL_SCROLLBACK_LINES 512
+#define SHELL_ATTR_NORMAL 0
+#define SHELL_DIR_CACHE_MAX 8
+#define SHELL_ARENA_SLABS 4
+#define SHELL_ARENA_SLAB_PAGES 64
+#define SHELL_ARENA_POOL_MAX 16
+
+// One open directory handle kept across commands, keyed by absolute path.
+typedef struct {
+    char path[SHELL_PATH_MAX];
+    EFI_FILE_PROTOCOL *handle;
+    UINT64 last_use;
+} ShellDirCacheEntry;
+
+// Running totals for the shell's own work, read as deltas by `perf`.
+typedef struct {
+    UINT64 allocs;
+    UINT64 pool_allocs;
+    UINT64 alloc_bytes;
+    UINT64 file_calls;
+    UINT64 file_read_bytes;
+    UINT64 file_write_bytes;
+} ShellCounters;
+
+// Per-command bump allocator behind shell_alloc. Slabs come from
+// AllocatePages on first use and are kept; reset rewinds them and frees the
+// pool blocks handed out for requests too large for a slab.
+typedef struct {
+    UINT8 *slabs[SHELL_ARENA_SLABS];
+    UINTN used[SHELL_ARENA_SLABS];
+    UINTN current;
+    void *last;
+    void *pool[SHELL_ARENA_POOL_MAX];
+    UINTN pool_count;
+} ShellArena;
+
+// Destination of shell_print/shell_putc while a command's output is piped
+// or redirected. An in-memory pipe (file == NULL) is bounded by cap and drops
+// the excess; a redirect buffers writes to `file` and flushes when full.
+typedef struct {
+    char *buf;
+    UINTN len;
+    UINTN cap;
+    UINTN read_pos;
+    EFI_FILE_PROTOCOL *file;
+    EFI_STATUS status;
+    BOOLEAN truncated;
+} ShellStream;
 
 typedef struct {
     EFI_HANDLE image_handle;
@@ -24,9 +73,48 @@ typedef struct {
     char cwd[SHELL_PATH_MAX];
     char history[SHELL_HISTORY_MAX][SHELL_INPUT_MAX];
     UINTN history_count;
+
+    // ESP volume opened once per session, plus an LRU of open directories
+    // so paths are opened relative to an already-open parent.
+    EFI_FILE_PROTOCOL *volume_root;
+    ShellDirCacheEntry dir_cache[SHELL_DIR_CACHE_MAX];
+    UINT64 dir_cache_clock;
+
+    ShellCounters counters;
+    ShellArena arena;
+
+    // Set once appending to the event log file has failed, which stops the
+    // flush at each prompt.
+    BOOLEAN event_log_failed;
+
+    // Where shell text goes (framebuffer, ConOut, serial, log, or none).
+    Console console;
+
+    // Output and input of the running pipeline stage. NULL `out` means the
+    // console; NULL `in` means nothing is piped in.
+    ShellStream *out;
+    ShellStream *in;
+
+    // Line being executed and the tokenizer's copy of it, in which every
+    // word sits at its offset in `line`. Lets echo print its arguments as
+    // typed. NULL outside shell_execute.
+    const char *line;
+    const char *line_words;
+
+    // Character-cell text model: a ring of `ring_lines` rows x `cols` cells.
+    // Live screen row r is ring line (ring_head + r) % ring_lines. NULL when
+    // the ring could not be allocated (pixel-only fallback).
+    char *cell_chars;
+    UINT8 *cell_attrs;
+    UINTN ring_lines;
+    UINTN ring_head;
+    UINTN ring_filled;
+    UINTN view_offset;
+    UINTN scrolls_since_paint;
+    BOOLEAN repaint_pending;
 } Shell;
 
-void shell_init(Shell *shell, EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContext *gfx);
+void shell_init(Shell *shell, EFI_HANDLE image_handle, EFI_SYSTEM_TABLE *st, GfxContext *gfx, UINT32 console_sinks);
 void shell_run(Shell *shell);
 void shell_print(Shell *shell, const char *text);
 void shell_println(Shell *shell, const char *text);
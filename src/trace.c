@@ -0,0 +1,94 @@
+#include "trace.h"
+#include "cpu.h"
+
+static TraceSpan *trace_spans = NULL;
+static UINT64 trace_next = 0;
+// Seq of the first span since the last trace_clear.
+static UINT64 trace_base = 0;
+// Seqs of the open spans, innermost last.
+static UINT64 trace_stack[TRACE_DEPTH_MAX];
+static UINTN trace_depth = 0;
+
+static const char *const trace_category_names[TRACE_CAT_COUNT] = {
+    "boot",
+    "shell",
+    "file",
+    "gfx",
+};
+
+BOOLEAN trace_init(EFI_BOOT_SERVICES *bs) {
+    if (trace_spans != NULL) {
+        return TRUE;
+    }
+    void *buf = NULL;
+    EFI_STATUS status = uefi_call_wrapper(bs->AllocatePool, 3, EfiLoaderData, TRACE_SPANS_MAX * sizeof(TraceSpan), &buf);
+    if (EFI_ERROR(status) || buf == NULL) {
+        return FALSE;
+    }
+    trace_spans = (TraceSpan *)buf;
+    return TRUE;
+}
+
+void trace_begin(TraceCategory category, const char *name) {
+    if (trace_spans == NULL) {
+        return;
+    }
+
+    UINT64 seq = trace_next++;
+    TraceSpan *span = &trace_spans[seq % TRACE_SPANS_MAX];
+    span->start = cpu_rdtsc();
+    span->end = 0;
+    span->name = name;
+    span->category = (UINT32)category;
+
+    if (trace_depth < TRACE_DEPTH_MAX) {
+        trace_stack[trace_depth] = seq;
+    }
+    trace_depth++;
+}
+
+void trace_end(void) {
+    if (trace_spans == NULL || trace_depth == 0) {
+        return;
+    }
+    trace_depth--;
+    // The slot may have been reused by a newer span (or the span cleared)
+    // while this one was open.
+    if (trace_depth < TRACE_DEPTH_MAX && trace_stack[trace_depth] >= trace_first_seq()) {
+        trace_spans[trace_stack[trace_depth] % TRACE_SPANS_MAX].end = cpu_rdtsc();
+    }
+}
+
+void trace_clear(void) {
+    trace_base = trace_next;
+}
+
+UINT64 trace_first_seq(void) {
+    if (trace_next - trace_base > TRACE_SPANS_MAX) {
+        return trace_next - TRACE_SPANS_MAX;
+    }
+    return trace_base;
+}
+
+UINT64 trace_next_seq(void) {
+    return trace_next;
+}
+
+const TraceSpan *trace_span(UINT64 seq) {
+    if (trace_spans == NULL || seq < trace_first_seq() || seq >= trace_next) {
+        return NULL;
+    }
+    return &trace_spans[seq % TRACE_SPANS_MAX];
+}
+
+UINTN trace_count(void) {
+    return (UINTN)(trace_next - trace_first_seq());
+}
+
+UINT64 trace_dropped(void) {
+    return trace_first_seq() - trace_base;
+}
+
+const char *trace_category_name(UINTN category) {
+    return (category < TRACE_CAT_COUNT) ? trace_category_names[category] : "?";
+}
@@ -0,0 +1,49 @@
+#ifndef HATTEROS_TRACE_H
+#define HATTEROS_TRACE_H
+
+#include <efi.h>
+
+// Span tracer for `trace save`: begin/end pairs recorded as complete spans
+// (TSC start and end) into a ring allocated once at boot, so it always holds
+// the most recent TRACE_SPANS_MAX spans. Recording is a TSC read and a few
+// stores; everything is a no-op until trace_init.
+#define TRACE_SPANS_MAX 8192
+#define TRACE_DEPTH_MAX 32
+
+typedef enum {
+    TRACE_CAT_BOOT = 0,
+    TRACE_CAT_SHELL,
+    TRACE_CAT_FILE,
+    TRACE_CAT_GFX,
+    TRACE_CAT_COUNT
+} TraceCategory;
+
+typedef struct {
+    UINT64 start;
+    UINT64 end;         // 0 while the span is still open
+    const char *name;   // static string; never copied
+    UINT32 category;
+} TraceSpan;
+
+BOOLEAN trace_init(EFI_BOOT_SERVICES *bs);
+
+// Spans nest: trace_end closes the most recent open trace_begin. When the
+// ring is full each new span overwrites the oldest one.
+void trace_begin(TraceCategory category, const char *name);
+void trace_end(void);
+
+// Forget recorded spans. Spans open at the time are not recorded.
+void trace_clear(void);
+
+// Spans are numbered in begin order. The ring holds trace_first_seq() up to
+// trace_next_seq(); trace_span returns NULL outside that window.
+UINT64 trace_first_seq(void);
+UINT64 trace_next_seq(void);
+const TraceSpan *trace_span(UINT64 seq);
+
+// Spans held, and spans overwritten since boot or the last trace_clear.
+UINTN trace_count(void);
+UINT64 trace_dropped(void);
+const char *trace_category_name(UINTN category);
+
+#endif
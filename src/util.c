@@ -98,24 +98,114 @@ void u_u64_to_hex(UINT64 value, char *out, UINTN out_size) {
     out[idx] = '\0';
 }
 
-// Serial logging intentionally disabled for portability/stability.
-void serial_init(void) {
-    // Intentionally left as a no-op.
-    // Direct x86 port I/O (COM1 outb) can trigger a GP fault in some UEFI
-    // execution environments depending on firmware/privilege configuration.
+// Serial output goes through the firmware's EFI_SERIAL_IO_PROTOCOL; direct
+// COM1 port I/O (outb) triggered GP faults in some UEFI environments. Text
+// is queued in a ring and handed to the firmware in large chunks by
+// serial_flush: when the ring fills, before the shell waits for a key, and
+// from a periodic timer event so long-running commands keep streaming.
+#define SERIAL_RING_SIZE 16384
+#define SERIAL_FLUSH_INTERVAL_MS 50
+
+static EFI_SERIAL_IO_PROTOCOL *serial_io = NULL;
+static EFI_EVENT serial_timer = NULL;
+static char serial_ring[SERIAL_RING_SIZE];
+// Free-running counters; head - tail is the number of queued bytes.
+static UINTN serial_head = 0;
+static UINTN serial_tail = 0;
+// Set while the ring is being changed so the timer callback keeps out.
+static volatile BOOLEAN serial_busy = FALSE;
+
+static void serial_drain(void) {
+    while (serial_tail != serial_head) {
+        UINTN offset = serial_tail % SERIAL_RING_SIZE;
+        UINTN chunk = serial_head - serial_tail;
+        if (chunk > SERIAL_RING_SIZE - offset) {
+            chunk = SERIAL_RING_SIZE - offset;
+        }
+
+        UINTN size = chunk;
+        EFI_STATUS status = uefi_call_wrapper(serial_io->Write, 3, serial_io, &size, &serial_ring[offset]);
+        if (EFI_ERROR(status) || size == 0) {
+            // A stuck port must not wedge the shell; drop what is queued.
+            serial_tail = serial_head;
+            return;
+        }
+        serial_tail += size;
+    }
 }
 
-static void serial_write_char(char c) {
-    (void)c;
+// Timer notify functions are called by the firmware, so this one uses the
+// UEFI (Microsoft x64) calling convention explicitly.
+static void __attribute__((ms_abi)) serial_timer_notify(EFI_EVENT event, void *context) {
+    (void)event;
+    (void)context;
+    serial_flush();
 }
 
-void serial_write(const char *text) {
-    while (*text) {
-        if (*text == '\n') {
-            serial_write_char('\r');
+void serial_init(EFI_SYSTEM_TABLE *st) {
+    if (serial_io != NULL || st == NULL || st->BootServices == NULL) {
+        return;
+    }
+
+    EFI_GUID serial_guid = EFI_SERIAL_IO_PROTOCOL_GUID;
+    EFI_SERIAL_IO_PROTOCOL *io = NULL;
+    EFI_STATUS status = uefi_call_wrapper(st->BootServices->LocateProtocol, 3, &serial_guid, NULL, (void **)&io);
+    if (EFI_ERROR(status) || io == NULL) {
+        return;
+    }
+    serial_io = io;
+
+    // Without the timer, output still goes out when the ring fills and at
+    // each prompt.
+    status = uefi_call_wrapper(
+        st->BootServices->CreateEvent,
+        5,
+        EVT_TIMER | EVT_NOTIFY_SIGNAL,
+        TPL_CALLBACK,
+        (EFI_EVENT_NOTIFY)serial_timer_notify,
+        NULL,
+        &serial_timer
+    );
+    if (!EFI_ERROR(status)) {
+        uefi_call_wrapper(st->BootServices->SetTimer, 3, serial_timer, TimerPeriodic,
+                          (UINT64)SERIAL_FLUSH_INTERVAL_MS * 10000ULL);
+    }
+}
+
+BOOLEAN serial_available(void) {
+    return serial_io != NULL;
+}
+
+void serial_write_n(const char *text, UINTN n) {
+    if (serial_io == NULL) {
+        return;
+    }
+
+    serial_busy = TRUE;
+    for (UINTN i = 0; i < n; i++) {
+        // Reserve two bytes so '\n' and its '\r' always fit together.
+        if (serial_head - serial_tail > SERIAL_RING_SIZE - 2) {
+            serial_drain();
+        }
+        if (text[i] == '\n') {
+            serial_ring[serial_head++ % SERIAL_RING_SIZE] = '\r';
         }
-        serial_write_char(*text++);
+        serial_ring[serial_head++ % SERIAL_RING_SIZE] = text[i];
     }
+    serial_busy = FALSE;
+}
+
+void serial_flush(void) {
+    if (serial_io == NULL || serial_busy) {
+        return;
+    }
+    serial_busy = TRUE;
+    serial_drain();
+    serial_busy = FALSE;
+}
+
+void serial_write(const char *text) {
+    serial_write_n(text, u_strlen(text));
 }
 
 void serial_writeln(const char *text) {
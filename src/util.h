@@ -14,8 +14,13 @@ char *u_trim_left(char *s);
 void u_u64_to_dec(UINT64 value, char *out, UINTN out_size);
 void u_u64_to_hex(UINT64 value, char *out, UINTN out_size);
 
-void serial_init(void);
+// Buffered serial output through EFI_SERIAL_IO_PROTOCOL. Writes only queue
+// bytes; serial_flush (and a periodic timer) hands them to the firmware.
+void serial_init(EFI_SYSTEM_TABLE *st);
+BOOLEAN serial_available(void);
+void serial_write_n(const char *text, UINTN n);
 void serial_write(const char *text);
 void serial_writeln(const char *text);
+void serial_flush(void);
 
 #endif
\ No newline at end of file